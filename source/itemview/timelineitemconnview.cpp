@@ -146,7 +146,7 @@ void TimelineItemConnView::fitInAxis()
     }
 
     qreal item_margin = from_item_view->itemMargin();
-    qreal x = scene_.mapFrameToAxisX(from_item->destination()) + scene_.axisTickWidth() / 2.0 - item_margin;
+    qreal x = scene_.mapFrameToAxisX(scene_.itemViewStart(conn_id_.from) + from_item->duration()) + scene_.axisTickWidth() / 2.0 - item_margin;
     prepareGeometryChange();
     if (!qFuzzyCompare(x, this->x())) {
         setX(x);
@@ -162,7 +162,7 @@ void TimelineItemConnView::updateX()
     }
 
     qreal item_margin = from_item_view->itemMargin();
-    qreal x = scene_.mapFrameToAxisX(from_item->destination()) + scene_.axisTickWidth() / 2.0 - item_margin;
+    qreal x = scene_.mapFrameToAxisX(scene_.itemViewStart(conn_id_.from) + from_item->duration()) + scene_.axisTickWidth() / 2.0 - item_margin;
     prepareGeometryChange();
     if (!qFuzzyCompare(x, this->x())) {
         setX(x);
@@ -6,6 +6,7 @@
 #include <QGraphicsDropShadowEffect>
 #include <QGraphicsSceneMouseEvent>
 #include <QPainter>
+#include <algorithm>
 
 namespace tl {
 TimelineItemView::TimelineItemView(ItemID item_id, TimelineScene* scene)
@@ -111,7 +112,8 @@ void TimelineItemView::updateX()
 
 void TimelineItemView::updateY()
 {
-    qreal new_y = model()->itemY(item_id_);
+    // 挂在行容器下时纵坐标和隐藏由容器决定
+    qreal new_y = parentItem() ? 0 : model()->itemY(item_id_);
     if (qFuzzyCompare(new_y, y())) {
         return;
     }
@@ -170,7 +172,28 @@ bool TimelineItemView::isInView() const
 void TimelineItemView::mousePressEvent(QGraphicsSceneMouseEvent* event)
 {
     QGraphicsObject::mousePressEvent(event);
-    start_bak_ = model()->item(item_id_)->start();
+    auto* item = model()->item(item_id_);
+    start_bak_ = item->start();
+    preview_start_ = -1;
+    drag_group_.clear();
+
+    auto selected_items = sceneRef().selectedItems();
+    if (selected_items.size() > 1 && selected_items.contains(item_id_)) {
+        drag_group_ = selected_items;
+    }
+    snap_filter_.excluded_items = { item_id_ };
+    snap_filter_.excluded_items.insert(drag_group_.begin(), drag_group_.end());
+
+    // 与modifyItemStart()/moveItems()的限制一致：不越过组外相邻的条目，也不移出视图范围
+    auto [min_delta, max_delta] = model()->groupMoveRange(drag_group_.isEmpty() ? QList<ItemID> { item_id_ } : drag_group_);
+    for (ItemID item_id : drag_group_) {
+        if (auto* group_item = model()->item(item_id)) {
+            min_delta = std::max(min_delta, model()->viewFrameMinimum() - group_item->start());
+            max_delta = std::min(max_delta, model()->viewFrameMaximum() - group_item->duration() - group_item->start());
+        }
+    }
+    drag_min_start_ = min_delta == std::numeric_limits<qint64>::min() ? min_delta : start_bak_ + min_delta;
+    drag_max_start_ = max_delta == std::numeric_limits<qint64>::max() ? max_delta : start_bak_ + max_delta;
 }
 
 void TimelineItemView::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
@@ -179,11 +202,37 @@ void TimelineItemView::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
     if (start_bak_ < 0) {
         return;
     }
-    auto guard = qScopeGuard([this] { start_bak_ = -1; });
+    auto guard = qScopeGuard([this] {
+        start_bak_ = -1;
+        preview_start_ = -1;
+        drag_group_.clear();
+        snap_filter_.excluded_items.clear();
+    });
     auto* item = model()->item(item_id_);
     if (!item) {
         return;
     }
+
+    if (!drag_group_.isEmpty()) {
+        // 整组平移只修改一次模型
+        if (preview_start_ >= 0 && preview_start_ != item->start()) {
+            emit requestMoveItems(drag_group_, preview_start_ - item->start());
+        }
+        for (ItemID item_id : drag_group_) {
+            if (auto* item_view = sceneRef().itemView(item_id)) {
+                item_view->setPreviewStart(-1);
+            }
+        }
+        return;
+    }
+
+    // 预览结束时才修改一次模型，宿主拒绝移动时视图回到模型中的位置
+    if (preview_start_ >= 0 && preview_start_ != item->start()) {
+        emit requestMoveItem(item_id_, preview_start_);
+    }
+    if (preview_start_ >= 0) {
+        setPreviewStart(-1);
+    }
     if (start_bak_ == item->start()) {
         return;
     }
@@ -196,19 +245,65 @@ void TimelineItemView::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
     if (!item) {
         return;
     }
-    qint64 frame_no = qRound64(event->pos().x() / sceneRef().axisFrameWidth() + item->start());
+    const bool preview = sceneRef().isDragPreviewEnabled() && start_bak_ >= 0;
+    const qint64 current_start = preview && preview_start_ >= 0 ? preview_start_ : item->start();
+    qint64 frame_no = qRound64(event->pos().x() / sceneRef().axisFrameWidth() + current_start);
+    if (start_bak_ >= 0) {
+        frame_no = sceneRef().snapItemStart(frame_no, item->duration(), snap_filter_);
+    }
     if (frame_no < model()->viewFrameMinimum()) {
         frame_no = model()->viewFrameMinimum();
     }
     if (frame_no > model()->viewFrameMaximum() - item->duration()) {
         frame_no = model()->viewFrameMaximum() - item->duration();
     }
-    if (frame_no == item->start()) {
+    if (preview || !drag_group_.isEmpty()) {
+        frame_no = std::clamp(frame_no, drag_min_start_, std::max(drag_min_start_, drag_max_start_));
+    }
+    if (frame_no == current_start) {
+        return;
+    }
+
+    if (!drag_group_.isEmpty()) {
+        if (!preview) {
+            emit requestMoveItems(drag_group_, frame_no - item->start());
+            return;
+        }
+        // 组内视图按同一偏移预览
+        const qint64 delta = frame_no - item->start();
+        for (ItemID item_id : drag_group_) {
+            auto* item_view = sceneRef().itemView(item_id);
+            auto* group_item = model()->item(item_id);
+            if (item_view && group_item) {
+                item_view->setPreviewStart(group_item->start() + delta);
+            }
+        }
+        return;
+    }
+    if (preview) {
+        setPreviewStart(frame_no);
         return;
     }
     emit requestMoveItem(item_id_, frame_no);
 }
 
+void TimelineItemView::setPreviewStart(qint64 frame_no)
+{
+    preview_start_ = frame_no;
+    if (frame_no < 0) {
+        updateX();
+    } else if (auto new_x = sceneRef().mapFrameToAxisX(frame_no); !qFuzzyCompare(new_x, x())) {
+        setX(new_x);
+    }
+    // 连接线跟随预览位置
+    sceneRef().updateItemConnViews(item_id_);
+}
+
+qint64 TimelineItemView::previewStart() const
+{
+    return preview_start_;
+}
+
 void TimelineItemView::refreshCache()
 {
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "timelinedef.h"
+#include "timelinesnapindex.h"
 #include <QGraphicsObject>
 
 namespace tl {
@@ -39,9 +40,15 @@ public:
     virtual void refreshCache();
     virtual void rebuildCache();
 
+    // 预览拖动时只移动视图，不修改模型；-1表示结束预览并回到模型中的位置
+    void setPreviewStart(qint64 frame_no);
+    qint64 previewStart() const;
+
 signals:
     void requestMoveItem(ItemID item_id, qint64 frame_no);
     void moveFinished(ItemID item_id, qint64 old_start);
+    // 拖动多选条目时整体平移
+    void requestMoveItems(const QList<ItemID>& item_ids, qint64 delta);
 
 protected:
     void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
@@ -52,6 +59,15 @@ protected:
     virtual QRectF calcBoundingRect() const;
 
     qint64 start_bak_ { -1 };
+    // 拖动预览中的起始帧，-1表示未在预览
+    qint64 preview_start_ { -1 };
+    // 按下时由相邻条目确定的可移动范围，拖动过程中不再查询模型
+    qint64 drag_min_start_ { 0 };
+    qint64 drag_max_start_ { 0 };
+    // 拖动的条目属于多选时，与之一起平移的全部条目
+    QList<ItemID> drag_group_;
+    // 拖动中的条目不作为吸附目标
+    TimelineSnapFilter snap_filter_;
 
     ItemID item_id_ { kInvalidItemID };
     mutable QRectF bounding_rect_;
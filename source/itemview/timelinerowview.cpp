@@ -0,0 +1,61 @@
+#include "timelinerowview.h"
+#include "timelinemodel.h"
+#include "timelinescene.h"
+
+namespace tl {
+
+TimelineRowView::TimelineRowView(int row, TimelineScene& scene)
+    : row_(row)
+    , scene_(scene)
+{
+    scene.addItem(this);
+    setFlag(QGraphicsItem::ItemHasNoContents, true);
+    setFlag(QGraphicsItem::ItemContainsChildrenInShape, true);
+    setAcceptedMouseButtons(Qt::NoButton);
+    updateGeometry();
+    updateLayout();
+}
+
+int TimelineRowView::row() const
+{
+    return row_;
+}
+
+QRectF TimelineRowView::boundingRect() const
+{
+    return bounding_rect_;
+}
+
+void TimelineRowView::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+}
+
+void TimelineRowView::updateLayout()
+{
+    auto* model = scene_.model();
+    const bool hidden = model->isRowHidden(row_);
+    if (hidden == isVisible()) {
+        setVisible(!hidden);
+    }
+    if (hidden) {
+        return;
+    }
+    qreal new_y = model->rowY(row_);
+    if (!qFuzzyCompare(new_y, y())) {
+        setY(new_y);
+    }
+}
+
+void TimelineRowView::updateGeometry()
+{
+    const QRectF scene_rect = scene_.sceneRect();
+    prepareGeometryChange();
+    bounding_rect_ = QRectF(scene_rect.left(), 0, scene_rect.width(), scene_.model()->itemHeight());
+}
+
+int TimelineRowView::type() const
+{
+    return Type;
+}
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QGraphicsItem>
+
+namespace tl {
+class TimelineScene;
+// 行容器：一行的条目视图和连接线视图都挂在它下面，子项纵坐标为0。
+// 行的显示位置和隐藏只修改容器本身；容器的形状覆盖整行，场景按行范围做纵向裁剪
+class TimelineRowView : public QGraphicsItem {
+public:
+    explicit TimelineRowView(int row, TimelineScene& scene);
+
+    int row() const;
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+    // 按模型更新纵坐标和隐藏状态
+    void updateLayout();
+    // 场景范围或条目高度变化后调用
+    void updateGeometry();
+
+    enum {
+        Type = UserType + 3,
+    };
+    int type() const override;
+
+private:
+    int row_ { -1 };
+    TimelineScene& scene_;
+    QRectF bounding_rect_;
+};
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "timelinearmplancompiler.h"
+#include "item/timelinearmitem.h"
+#include "timelinemodel.h"
+#include <algorithm>
+#include <mutex>
+#include <set>
+
+namespace tl {
+
+namespace {
+void fillSegment(TimelineArmPlan::Segment& segment, const TimelineArmItem* item)
+{
+    segment.item_id = item->itemId();
+    segment.arrive_frame = item->start();
+    segment.dwell_frames = item->duration();
+    segment.flags = item->isTrackingAim() ? TimelineArmPlan::TrackingAimFlag : TimelineArmPlan::NoFlag;
+}
+
+constexpr int kPatchRoles = TimelineItem::StartRole | TimelineItem::DurationRole | TimelineArmItem::JointAnglesRole | TimelineArmItem::TrackingAimRole;
+} // namespace
+
+qsizetype TimelineArmPlan::segmentIndexAt(qint64 frame_no) const
+{
+    auto it = std::upper_bound(segments.begin(), segments.end(), frame_no, [](qint64 frame, const Segment& segment) { return frame < segment.arrive_frame; });
+    return std::distance(segments.begin(), it) - 1;
+}
+
+struct TimelineArmPlanCompilerPrivate {
+    TimelineModel* model { nullptr };
+
+    mutable std::mutex plans_mutex;
+    std::map<int, std::shared_ptr<const TimelineArmPlan>> plans;
+
+    // 以下只在GUI线程中访问
+    // {row: {item_id: segment index}}
+    std::map<int, std::unordered_map<ItemID, std::size_t>> segment_index;
+    std::set<int> dirty_rows;
+    std::map<int, std::vector<ItemID>> dirty_items;
+    quint64 version { 0 };
+    bool compile_pending { false };
+};
+
+TimelineArmPlanCompiler::TimelineArmPlanCompiler(TimelineModel* model, QObject* parent)
+    : QObject(parent)
+    , d_(new TimelineArmPlanCompilerPrivate)
+{
+    d_->model = model;
+    connect(model, &TimelineModel::itemCreated, this, &TimelineArmPlanCompiler::onItemCreated);
+    connect(model, &TimelineModel::itemRemoved, this, &TimelineArmPlanCompiler::onItemRemoved);
+    connect(model, &TimelineModel::itemChanged, this, &TimelineArmPlanCompiler::onItemChanged);
+    connect(model, &TimelineModel::itemsCreated, this, [this](const QList<ItemID>& item_ids) {
+        for (ItemID item_id : item_ids) {
+            onItemCreated(item_id);
+        }
+    });
+    connect(model, &TimelineModel::itemsRemoved, this, [this](const QList<ItemID>& item_ids) {
+        for (ItemID item_id : item_ids) {
+            onItemRemoved(item_id);
+        }
+    });
+    connect(model, &TimelineModel::itemsChanged, this, [this](const QList<ItemID>& item_ids, int role) {
+        for (ItemID item_id : item_ids) {
+            onItemChanged(item_id, role);
+        }
+    });
+    connect(model, &TimelineModel::itemConnCreated, this, &TimelineArmPlanCompiler::onItemConnChanged);
+    connect(model, &TimelineModel::itemConnRemoved, this, &TimelineArmPlanCompiler::onItemConnChanged);
+    // 加载工程后整体重建，合并到下一个事件循环周期，不阻塞首帧绘制
+    connect(model, &TimelineModel::modelReset, this, [this] {
+        markAllRowsDirty();
+        scheduleCompile();
+    });
+    // 与TimelineTrajectorySampler一致，禁用类型的条目不进入计划
+    connect(model, &TimelineModel::typeDisabledChanged, this, [this](int type) {
+        if (type == TimelineArmItem::Type) {
+            markAllRowsDirty();
+            scheduleCompile();
+        }
+    });
+    connect(model, &TimelineModel::fpsChanged, this, [this] {
+        // fps只影响计划的元数据，按空修改列表复用上一版计划
+        for (const auto& [row, _] : d_->segment_index) {
+            d_->dirty_items[row];
+        }
+        scheduleCompile();
+    });
+    invalidate();
+}
+
+TimelineArmPlanCompiler::~TimelineArmPlanCompiler() noexcept
+{
+    delete d_;
+}
+
+TimelineModel* TimelineArmPlanCompiler::model() const
+{
+    return d_->model;
+}
+
+std::shared_ptr<const TimelineArmPlan> TimelineArmPlanCompiler::plan(int row) const
+{
+    std::lock_guard lock(d_->plans_mutex);
+    auto it = d_->plans.find(row);
+    if (it == d_->plans.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void TimelineArmPlanCompiler::compile()
+{
+    d_->compile_pending = false;
+    auto dirty_rows = std::exchange(d_->dirty_rows, {});
+    auto dirty_items = std::exchange(d_->dirty_items, {});
+
+    for (int row : dirty_rows) {
+        publish(row, buildRow(row));
+    }
+    for (const auto& [row, item_ids] : dirty_items) {
+        if (dirty_rows.contains(row)) {
+            continue;
+        }
+        auto plan = patchRow(row, item_ids);
+        if (!plan) {
+            plan = buildRow(row);
+        }
+        publish(row, std::move(plan));
+    }
+}
+
+void TimelineArmPlanCompiler::invalidate()
+{
+    markAllRowsDirty();
+    compile();
+}
+
+void TimelineArmPlanCompiler::markAllRowsDirty()
+{
+    d_->dirty_items.clear();
+    for (int row = 0; row < d_->model->rowCount(); ++row) {
+        d_->dirty_rows.emplace(row);
+    }
+    // 模型行数减少后残留的计划也需要清理
+    for (const auto& [row, _] : d_->segment_index) {
+        d_->dirty_rows.emplace(row);
+    }
+}
+
+void TimelineArmPlanCompiler::onItemCreated(ItemID item_id)
+{
+    if (TimelineModel::itemType(item_id) == TimelineArmItem::Type) {
+        markRowDirty(TimelineModel::itemRow(item_id));
+    }
+}
+
+void TimelineArmPlanCompiler::onItemRemoved(ItemID item_id)
+{
+    if (TimelineModel::itemType(item_id) == TimelineArmItem::Type) {
+        markRowDirty(TimelineModel::itemRow(item_id));
+    }
+}
+
+void TimelineArmPlanCompiler::onItemChanged(ItemID item_id, int role)
+{
+    if (TimelineModel::itemType(item_id) != TimelineArmItem::Type) {
+        return;
+    }
+    if (role & TimelineItem::EnabledRole) {
+        markRowDirty(TimelineModel::itemRow(item_id));
+    } else if (role & kPatchRoles) {
+        markItemDirty(item_id);
+    }
+}
+
+void TimelineArmPlanCompiler::onItemConnChanged(const ItemConnID& conn_id)
+{
+    // 连接只影响起点段的运动帧数
+    if (TimelineModel::itemType(conn_id.from) == TimelineArmItem::Type) {
+        markItemDirty(conn_id.from);
+    }
+}
+
+void TimelineArmPlanCompiler::markRowDirty(int row)
+{
+    d_->dirty_rows.emplace(row);
+    scheduleCompile();
+}
+
+void TimelineArmPlanCompiler::markItemDirty(ItemID item_id)
+{
+    int row = TimelineModel::itemRow(item_id);
+    if (d_->dirty_rows.contains(row)) {
+        return;
+    }
+    d_->dirty_items[row].emplace_back(item_id);
+    scheduleCompile();
+}
+
+void TimelineArmPlanCompiler::scheduleCompile()
+{
+    if (d_->compile_pending) {
+        return;
+    }
+    d_->compile_pending = true;
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            if (d_->compile_pending) {
+                compile();
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+std::shared_ptr<TimelineArmPlan> TimelineArmPlanCompiler::buildRow(int row)
+{
+    auto& index = d_->segment_index[row];
+    index.clear();
+
+    auto plan = std::make_shared<TimelineArmPlan>();
+    plan->row = row;
+    plan->fps = d_->model->fps();
+    for (const auto& [_, item_id] : d_->model->rowItemRange(row)) {
+        if (TimelineModel::itemType(item_id) != TimelineArmItem::Type) {
+            continue;
+        }
+        auto* item = d_->model->item<TimelineArmItem>(item_id);
+        if (!item || !item->isEnabled() || d_->model->isItemDisabled(item_id)) {
+            continue;
+        }
+        const auto& angles = item->angles();
+        TimelineArmPlan::Segment segment;
+        fillSegment(segment, item);
+        segment.joint_offset = static_cast<quint32>(plan->joints.size());
+        segment.joint_count = static_cast<quint32>(angles.size());
+        plan->joints.insert(plan->joints.end(), angles.begin(), angles.end());
+        index[item_id] = plan->segments.size();
+        plan->segments.emplace_back(segment);
+    }
+
+    if (plan->segments.empty()) {
+        d_->segment_index.erase(row);
+        return nullptr;
+    }
+
+    for (std::size_t i = 0; i + 1 < plan->segments.size(); ++i) {
+        auto& segment = plan->segments[i];
+        const auto& next = plan->segments[i + 1];
+        if (d_->model->nextConnection(segment.item_id).to == next.item_id) {
+            segment.travel_frames = next.arrive_frame - (segment.arrive_frame + segment.dwell_frames);
+        }
+    }
+    return plan;
+}
+
+std::shared_ptr<TimelineArmPlan> TimelineArmPlanCompiler::patchRow(int row, const std::vector<ItemID>& item_ids)
+{
+    auto old_plan = plan(row);
+    auto index_it = d_->segment_index.find(row);
+    if (!old_plan || index_it == d_->segment_index.end()) {
+        return nullptr;
+    }
+
+    auto plan = std::make_shared<TimelineArmPlan>(*old_plan);
+    plan->fps = d_->model->fps();
+    auto& segments = plan->segments;
+
+    std::set<std::size_t> touched;
+    for (ItemID item_id : item_ids) {
+        auto it = index_it->second.find(item_id);
+        auto* item = d_->model->item<TimelineArmItem>(item_id);
+        if (it == index_it->second.end() || !item || !item->isEnabled() || d_->model->isItemDisabled(item_id)) {
+            return nullptr;
+        }
+        auto& segment = segments[it->second];
+        const auto& angles = item->angles();
+        // 关节数变化会改变joints布局，整行重新编译
+        if (angles.size() != segment.joint_count) {
+            return nullptr;
+        }
+        fillSegment(segment, item);
+        std::copy(angles.begin(), angles.end(), plan->joints.begin() + segment.joint_offset);
+        touched.emplace(it->second);
+        if (it->second > 0) {
+            touched.emplace(it->second - 1);
+        }
+    }
+
+    for (std::size_t i : touched) {
+        auto& segment = segments[i];
+        segment.travel_frames = 0;
+        if (i + 1 >= segments.size()) {
+            continue;
+        }
+        const auto& next = segments[i + 1];
+        // 起始帧修改不会改变行内顺序，出现乱序说明状态已失效
+        if (next.arrive_frame <= segment.arrive_frame + segment.dwell_frames) {
+            return nullptr;
+        }
+        if (d_->model->nextConnection(segment.item_id).to == next.item_id) {
+            segment.travel_frames = next.arrive_frame - (segment.arrive_frame + segment.dwell_frames);
+        }
+    }
+    return plan;
+}
+
+void TimelineArmPlanCompiler::publish(int row, std::shared_ptr<TimelineArmPlan> plan)
+{
+    if (!plan) {
+        bool erased = false;
+        {
+            std::lock_guard lock(d_->plans_mutex);
+            erased = d_->plans.erase(row) > 0;
+        }
+        if (erased) {
+            emit planUpdated(row, 0);
+        }
+        return;
+    }
+
+    plan->version = ++d_->version;
+    const quint64 version = plan->version;
+    {
+        std::lock_guard lock(d_->plans_mutex);
+        d_->plans[row] = std::move(plan);
+    }
+    emit planUpdated(row, version);
+}
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "timelinedef.h"
+#include "timelinelibexport.h"
+#include <QObject>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace tl {
+
+class TimelineModel;
+struct TimelineArmPlanCompilerPrivate;
+
+// 一行Arm条目编译后的不可变运动计划。
+// 每个段表示：在arrive_frame到达目标关节角度，停留dwell_frames帧，然后沿连接用travel_frames帧运动到下一段的目标。
+// 发布后不再修改，可在任意线程中读取。
+struct TIMELINE_LIB_EXPORT TimelineArmPlan {
+    enum SegmentFlag : int {
+        NoFlag = 0x00,
+        TrackingAimFlag = 0x01,
+    };
+
+    struct Segment {
+        ItemID item_id { kInvalidItemID };
+        qint64 arrive_frame { 0 };
+        qint64 dwell_frames { 0 };
+        // 无连接时为0，表示停在该目标上直到下一段开始
+        qint64 travel_frames { 0 };
+        quint32 joint_offset { 0 };
+        quint32 joint_count { 0 };
+        int flags { NoFlag };
+    };
+
+    int row { -1 };
+    quint64 version { 0 };
+    double fps { 24.0 };
+    std::vector<Segment> segments;
+    // 所有段的目标关节角度连续存放，由Segment::joint_offset/joint_count索引
+    std::vector<double> joints;
+
+    inline std::span<const double> jointTargets(const Segment& segment) const;
+    // frame_no所在段的下标（最后一个arrive_frame不大于frame_no的段），在首段之前返回-1
+    qsizetype segmentIndexAt(qint64 frame_no) const;
+};
+
+inline std::span<const double> TimelineArmPlan::jointTargets(const Segment& segment) const
+{
+    return { joints.data() + segment.joint_offset, segment.joint_count };
+}
+
+// 将模型中的Arm行编译为TimelineArmPlan，并跟随模型的变更通知增量更新。
+// 同一事件循环周期内的多次修改合并为一次编译；只修改条目数值（起始帧、停留、角度、跟随）时复用上一版计划，
+// 增删条目或启用状态变化时整行重新编译。
+class TIMELINE_LIB_EXPORT TimelineArmPlanCompiler : public QObject {
+    Q_OBJECT
+public:
+    explicit TimelineArmPlanCompiler(TimelineModel* model, QObject* parent = nullptr);
+    ~TimelineArmPlanCompiler() noexcept override;
+
+    TimelineModel* model() const;
+
+    // 线程安全，返回行的最新计划，行内没有Arm条目时返回nullptr
+    std::shared_ptr<const TimelineArmPlan> plan(int row) const;
+
+    // 立即处理所有待编译的修改
+    void compile();
+    // 丢弃增量状态，所有行重新编译
+    void invalidate();
+
+signals:
+    void planUpdated(int row, quint64 version);
+
+private:
+    void onItemCreated(ItemID item_id);
+    void onItemRemoved(ItemID item_id);
+    void onItemChanged(ItemID item_id, int role);
+    void onItemConnChanged(const ItemConnID& conn_id);
+
+    void markRowDirty(int row);
+    void markAllRowsDirty();
+    void markItemDirty(ItemID item_id);
+    void scheduleCompile();
+
+    std::shared_ptr<TimelineArmPlan> buildRow(int row);
+    std::shared_ptr<TimelineArmPlan> patchRow(int row, const std::vector<ItemID>& item_ids);
+    void publish(int row, std::shared_ptr<TimelineArmPlan> plan);
+
+private:
+    TimelineArmPlanCompilerPrivate* d_ { nullptr };
+};
+
+} // namespace tl
\ No newline at end of file
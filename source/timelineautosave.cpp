@@ -0,0 +1,528 @@
+#include "timelineautosave.h"
+#include "item/timelineitem.h"
+#include "nlohmann/json.hpp"
+#include "timelinemodel.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QTimer>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <thread>
+
+namespace tl {
+
+namespace {
+constexpr int kDefaultFlushInterval = 1000;
+constexpr qint64 kDefaultCompactThreshold = 8 * 1024 * 1024;
+
+const QString kSnapshotPrefix = QStringLiteral("snapshot.");
+const QString kSnapshotSuffix = QStringLiteral(".msgpack");
+const QString kJournalPrefix = QStringLiteral("journal.");
+const QString kJournalSuffix = QStringLiteral(".jsonl");
+
+QString segmentPath(const QString& directory, const QString& prefix, quint64 segment, const QString& suffix)
+{
+    return QDir(directory).filePath(prefix + QString::number(segment) + suffix);
+}
+
+// 目录中某类文件的分段编号，升序
+std::vector<quint64> listSegments(const QString& directory, const QString& prefix, const QString& suffix)
+{
+    std::vector<quint64> segments;
+    for (const auto& name : QDir(directory).entryList({ prefix + "*" + suffix }, QDir::Files)) {
+        bool ok = false;
+        quint64 segment = name.mid(prefix.size(), name.size() - prefix.size() - suffix.size()).toULongLong(&ok);
+        if (ok) {
+            segments.emplace_back(segment);
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+void appendRecord(std::string& out, const nlohmann::json& record)
+{
+    out += record.dump();
+    out += '\n';
+}
+
+// 快照加日志重放得到的工程数据，只在合并和恢复时使用，不涉及模型
+struct ProjectState {
+    nlohmann::json header;
+    std::map<ItemID, nlohmann::json> items;
+    std::map<ItemID, ItemConnID> prev_conns;
+    std::map<ItemID, ItemConnID> next_conns;
+
+    bool loadSnapshot(const QString& file_path)
+    {
+        QFile file(file_path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            TL_LOG_ERROR("Failed to open autosave snapshot {}", file_path.toStdString());
+            return false;
+        }
+        try {
+            QByteArray data = file.readAll();
+            auto j = nlohmann::json::from_msgpack(data.begin(), data.end());
+            for (const auto& item_j : j["items"]) {
+                items[item_j["id"].get<ItemID>()] = item_j["data"];
+            }
+            auto load_conns = [](const nlohmann::json& conns_j, std::map<ItemID, ItemConnID>& conns) {
+                for (const auto& conn_item_j : conns_j) {
+                    const auto& conn_j = conn_item_j["connection"];
+                    conns[conn_item_j["item_id"].get<ItemID>()] = ItemConnID { conn_j[0].get<ItemID>(), conn_j[1].get<ItemID>() };
+                }
+            };
+            load_conns(j["prev_conns"], prev_conns);
+            load_conns(j["next_conns"], next_conns);
+            j.erase("items");
+            j.erase("prev_conns");
+            j.erase("next_conns");
+            header = std::move(j);
+        } catch (const std::exception& excep) {
+            TL_LOG_ERROR("Failed to parse autosave snapshot {}. Exception: {}", file_path.toStdString(), excep.what());
+            return false;
+        }
+        return true;
+    }
+
+    void replayJournal(const QString& file_path)
+    {
+        QFile file(file_path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return;
+        }
+        while (!file.atEnd()) {
+            QByteArray line = file.readLine().trimmed();
+            if (line.isEmpty()) {
+                continue;
+            }
+            // 崩溃时最后一条记录可能只写入了一半
+            try {
+                apply(nlohmann::json::parse(line.begin(), line.end()));
+            } catch (const std::exception& excep) {
+                TL_LOG_WARN("Skip broken autosave record in {}. Exception: {}", file_path.toStdString(), excep.what());
+            }
+        }
+    }
+
+    void apply(const nlohmann::json& record)
+    {
+        const auto& op = record.at("op").get_ref<const std::string&>();
+        if (op == "item") {
+            items[record.at("id").get<ItemID>()] = record.at("data");
+        } else if (op == "remove") {
+            items.erase(record.at("id").get<ItemID>());
+        } else if (op == "conn" || op == "unconn") {
+            ItemConnID conn_id { record.at("from").get<ItemID>(), record.at("to").get<ItemID>() };
+            if (op == "conn") {
+                next_conns[conn_id.from] = conn_id;
+                prev_conns[conn_id.to] = conn_id;
+                return;
+            }
+            if (auto it = next_conns.find(conn_id.from); it != next_conns.end() && it->second.to == conn_id.to) {
+                next_conns.erase(it);
+            }
+            if (auto it = prev_conns.find(conn_id.to); it != prev_conns.end() && it->second.from == conn_id.from) {
+                prev_conns.erase(it);
+            }
+        } else if (op == "header") {
+            header = record.at("header");
+        }
+    }
+
+    nlohmann::json toProject() const
+    {
+        nlohmann::json j = header;
+        auto& items_j = j["items"] = nlohmann::json::array();
+        for (const auto& [item_id, data] : items) {
+            items_j.push_back({ { "id", item_id }, { "data", data } });
+        }
+        auto save_conns = [](const std::map<ItemID, ItemConnID>& conns) {
+            nlohmann::json conns_j = nlohmann::json::array();
+            for (const auto& [item_id, conn_id] : conns) {
+                conns_j.push_back({ { "item_id", item_id }, { "connection", { conn_id.from, conn_id.to } } });
+            }
+            return conns_j;
+        };
+        j["prev_conns"] = save_conns(prev_conns);
+        j["next_conns"] = save_conns(next_conns);
+        return j;
+    }
+};
+
+// 在后台线程中执行：快照snapshot_segment加上其后到last_segment为止的日志合并为新快照
+bool compactSegments(const QString& directory, quint64 snapshot_segment, quint64 last_segment)
+{
+    ProjectState state;
+    if (!state.loadSnapshot(segmentPath(directory, kSnapshotPrefix, snapshot_segment, kSnapshotSuffix))) {
+        return false;
+    }
+    const auto journals = listSegments(directory, kJournalPrefix, kJournalSuffix);
+    for (quint64 segment : journals) {
+        if (segment > snapshot_segment && segment <= last_segment) {
+            state.replayJournal(segmentPath(directory, kJournalPrefix, segment, kJournalSuffix));
+        }
+    }
+
+    std::vector<std::uint8_t> data;
+    nlohmann::json::to_msgpack(state.toProject(), data);
+    QSaveFile file(segmentPath(directory, kSnapshotPrefix, last_segment, kSnapshotSuffix));
+    if (!file.open(QIODevice::WriteOnly) || file.write(reinterpret_cast<const char*>(data.data()), static_cast<qint64>(data.size())) != static_cast<qint64>(data.size())
+        || !file.commit()) {
+        TL_LOG_ERROR("Failed to write autosave snapshot. Error: {}", file.errorString().toStdString());
+        return false;
+    }
+
+    // 新快照已落盘，之前的快照和已合并的日志不再需要
+    QFile::remove(segmentPath(directory, kSnapshotPrefix, snapshot_segment, kSnapshotSuffix));
+    for (quint64 segment : journals) {
+        if (segment <= last_segment) {
+            QFile::remove(segmentPath(directory, kJournalPrefix, segment, kJournalSuffix));
+        }
+    }
+    return true;
+}
+
+void removeAutosaveFiles(const QString& directory)
+{
+    for (quint64 segment : listSegments(directory, kSnapshotPrefix, kSnapshotSuffix)) {
+        QFile::remove(segmentPath(directory, kSnapshotPrefix, segment, kSnapshotSuffix));
+    }
+    for (quint64 segment : listSegments(directory, kJournalPrefix, kJournalSuffix)) {
+        QFile::remove(segmentPath(directory, kJournalPrefix, segment, kJournalSuffix));
+    }
+}
+} // namespace
+
+struct TimelineAutosavePrivate {
+    TimelineModel* model { nullptr };
+    QString directory;
+    QTimer* flush_timer { nullptr };
+    qint64 compact_threshold { kDefaultCompactThreshold };
+    bool active { false };
+
+    QFile journal;
+    quint64 snapshot_segment { 0 };
+    quint64 journal_segment { 0 };
+    qint64 journal_bytes { 0 };
+
+    // 删除与连接的记录按发生顺序缓存；条目修改只记录ID，写入时取最新数据
+    std::string pending_records;
+    std::set<ItemID> dirty_items;
+    nlohmann::json last_header;
+
+    std::unique_ptr<std::jthread> compact_thread;
+    bool compacting { false };
+    // 重写基准快照后丢弃旧的合并结果
+    quint64 generation { 0 };
+};
+
+TimelineAutosave::TimelineAutosave(TimelineModel* model, const QString& directory, QObject* parent)
+    : QObject(parent)
+    , d_(new TimelineAutosavePrivate)
+{
+    d_->model = model;
+    d_->directory = directory;
+    d_->flush_timer = new QTimer(this);
+    d_->flush_timer->setSingleShot(true);
+    d_->flush_timer->setInterval(kDefaultFlushInterval);
+    connect(d_->flush_timer, &QTimer::timeout, this, &TimelineAutosave::flush);
+
+    connect(model, &TimelineModel::itemCreated, this, &TimelineAutosave::markItemDirty);
+    connect(model, &TimelineModel::itemChanged, this, &TimelineAutosave::onItemChanged);
+    connect(model, &TimelineModel::itemRemoved, this, &TimelineAutosave::onItemRemoved);
+    connect(model, &TimelineModel::itemsCreated, this, [this](const QList<ItemID>& item_ids) {
+        for (ItemID item_id : item_ids) {
+            markItemDirty(item_id);
+        }
+    });
+    connect(model, &TimelineModel::itemsRemoved, this, [this](const QList<ItemID>& item_ids) {
+        for (ItemID item_id : item_ids) {
+            onItemRemoved(item_id);
+        }
+    });
+    connect(model, &TimelineModel::itemsChanged, this, [this](const QList<ItemID>& item_ids, int role) {
+        for (ItemID item_id : item_ids) {
+            onItemChanged(item_id, role);
+        }
+    });
+    connect(model, &TimelineModel::itemConnCreated, this, [this](const ItemConnID& conn_id) { onItemConnChanged(conn_id, true); });
+    connect(model, &TimelineModel::itemConnRemoved, this, [this](const ItemConnID& conn_id) { onItemConnChanged(conn_id, false); });
+    // 工程头信息在写入时与上次比较
+    connect(model, &TimelineModel::rowCountChanged, this, &TimelineAutosave::scheduleFlush);
+    connect(model, &TimelineModel::frameMaximumChanged, this, &TimelineAutosave::scheduleFlush);
+    connect(model, &TimelineModel::frameMinimumChanged, this, &TimelineAutosave::scheduleFlush);
+    connect(model, &TimelineModel::viewFrameMaximumChanged, this, &TimelineAutosave::scheduleFlush);
+    connect(model, &TimelineModel::viewFrameMinimumChanged, this, &TimelineAutosave::scheduleFlush);
+    connect(model, &TimelineModel::modelReset, this, [this] {
+        if (d_->active) {
+            writeBaseline();
+        }
+    });
+}
+
+TimelineAutosave::~TimelineAutosave() noexcept
+{
+    stop();
+    delete d_;
+}
+
+TimelineModel* TimelineAutosave::model() const
+{
+    return d_->model;
+}
+
+QString TimelineAutosave::directory() const
+{
+    return d_->directory;
+}
+
+void TimelineAutosave::setFlushInterval(int msec)
+{
+    d_->flush_timer->setInterval(msec);
+}
+
+int TimelineAutosave::flushInterval() const
+{
+    return d_->flush_timer->interval();
+}
+
+void TimelineAutosave::setCompactThreshold(qint64 bytes)
+{
+    d_->compact_threshold = bytes;
+}
+
+qint64 TimelineAutosave::compactThreshold() const
+{
+    return d_->compact_threshold;
+}
+
+bool TimelineAutosave::start()
+{
+    if (d_->active) {
+        return true;
+    }
+    if (!QDir().mkpath(d_->directory)) {
+        TL_LOG_ERROR("Failed to create autosave directory {}", d_->directory.toStdString());
+        return false;
+    }
+    d_->active = writeBaseline();
+    return d_->active;
+}
+
+void TimelineAutosave::stop()
+{
+    if (!d_->active) {
+        waitForCompaction();
+        return;
+    }
+    flush();
+    waitForCompaction();
+    d_->flush_timer->stop();
+    d_->journal.close();
+    d_->active = false;
+}
+
+bool TimelineAutosave::isActive() const
+{
+    return d_->active;
+}
+
+void TimelineAutosave::flush()
+{
+    if (!d_->active) {
+        return;
+    }
+    d_->flush_timer->stop();
+
+    std::string out;
+    auto header = d_->model->saveHeader();
+    if (header != d_->last_header) {
+        appendRecord(out, { { "op", "header" }, { "header", header } });
+        d_->last_header = std::move(header);
+    }
+    out += d_->pending_records;
+    d_->pending_records.clear();
+    for (ItemID item_id : d_->dirty_items) {
+        // 写入前已删除的条目由删除记录处理
+        if (d_->model->exists(item_id)) {
+            appendRecord(out, { { "op", "item" }, { "id", item_id }, { "data", d_->model->itemData(item_id) } });
+        }
+    }
+    d_->dirty_items.clear();
+    if (out.empty()) {
+        return;
+    }
+
+    const auto size = static_cast<qint64>(out.size());
+    if (d_->journal.write(out.data(), size) != size || !d_->journal.flush()) {
+        TL_LOG_ERROR("Failed to write autosave journal. Error: {}", d_->journal.errorString().toStdString());
+        return;
+    }
+    d_->journal_bytes += size;
+    if (d_->journal_bytes >= d_->compact_threshold) {
+        compact();
+    }
+}
+
+void TimelineAutosave::compact()
+{
+    if (!d_->active || d_->compacting) {
+        return;
+    }
+    if (!d_->dirty_items.empty() || !d_->pending_records.empty()) {
+        // flush()在超过阈值时会回到这里
+        flush();
+        return;
+    }
+    if (d_->journal_bytes == 0) {
+        return;
+    }
+
+    // 切换到新的日志分段，后台只读取已关闭的分段
+    d_->journal.close();
+    const quint64 last_segment = d_->journal_segment++;
+    d_->journal.setFileName(segmentPath(d_->directory, kJournalPrefix, d_->journal_segment, kJournalSuffix));
+    if (!d_->journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        TL_LOG_ERROR("Failed to open autosave journal. Error: {}", d_->journal.errorString().toStdString());
+        d_->active = false;
+        return;
+    }
+    d_->journal_bytes = 0;
+
+    waitForCompaction();
+    d_->compacting = true;
+    d_->compact_thread = std::make_unique<std::jthread>(
+        [this, directory = d_->directory, snapshot_segment = d_->snapshot_segment, last_segment, generation = d_->generation] {
+            bool ok = compactSegments(directory, snapshot_segment, last_segment);
+            QMetaObject::invokeMethod(
+                this,
+                [this, ok, last_segment, generation] {
+                    if (generation != d_->generation) {
+                        return;
+                    }
+                    d_->compacting = false;
+                    if (ok) {
+                        d_->snapshot_segment = last_segment;
+                    }
+                    emit compactFinished(ok);
+                },
+                Qt::QueuedConnection);
+        });
+}
+
+void TimelineAutosave::discard()
+{
+    stop();
+    removeAutosaveFiles(d_->directory);
+}
+
+bool TimelineAutosave::hasRecoveryData(const QString& directory)
+{
+    return !listSegments(directory, kSnapshotPrefix, kSnapshotSuffix).empty();
+}
+
+bool TimelineAutosave::recover(TimelineModel& model, const QString& directory)
+{
+    const auto snapshots = listSegments(directory, kSnapshotPrefix, kSnapshotSuffix);
+    if (snapshots.empty()) {
+        return false;
+    }
+    // 合并中途崩溃时可能残留旧快照，以最新的为准；已合并的日志重放是幂等的
+    const quint64 snapshot_segment = snapshots.back();
+    ProjectState state;
+    if (!state.loadSnapshot(segmentPath(directory, kSnapshotPrefix, snapshot_segment, kSnapshotSuffix))) {
+        return false;
+    }
+    for (quint64 segment : listSegments(directory, kJournalPrefix, kJournalSuffix)) {
+        if (segment > snapshot_segment) {
+            state.replayJournal(segmentPath(directory, kJournalPrefix, segment, kJournalSuffix));
+        }
+    }
+    return model.load(state.toProject());
+}
+
+void TimelineAutosave::onItemChanged(ItemID item_id, int role)
+{
+    // 提示文本不是工程数据
+    if ((role & ~TimelineItem::ToolTipRole) == 0) {
+        return;
+    }
+    markItemDirty(item_id);
+}
+
+void TimelineAutosave::onItemRemoved(ItemID item_id)
+{
+    if (!d_->active) {
+        return;
+    }
+    d_->dirty_items.erase(item_id);
+    appendRecord(d_->pending_records, { { "op", "remove" }, { "id", item_id } });
+    scheduleFlush();
+}
+
+void TimelineAutosave::onItemConnChanged(const ItemConnID& conn_id, bool created)
+{
+    if (!d_->active) {
+        return;
+    }
+    appendRecord(d_->pending_records, { { "op", created ? "conn" : "unconn" }, { "from", conn_id.from }, { "to", conn_id.to } });
+    scheduleFlush();
+}
+
+void TimelineAutosave::markItemDirty(ItemID item_id)
+{
+    if (!d_->active) {
+        return;
+    }
+    d_->dirty_items.emplace(item_id);
+    scheduleFlush();
+}
+
+void TimelineAutosave::scheduleFlush()
+{
+    if (d_->active && !d_->flush_timer->isActive()) {
+        d_->flush_timer->start();
+    }
+}
+
+void TimelineAutosave::waitForCompaction()
+{
+    if (d_->compact_thread) {
+        d_->compact_thread->join();
+        d_->compact_thread.reset();
+    }
+    d_->compacting = false;
+}
+
+bool TimelineAutosave::writeBaseline()
+{
+    // 以当前模型重写快照，只在开始记录和模型整体重置时发生
+    waitForCompaction();
+    ++d_->generation;
+    d_->journal.close();
+    d_->pending_records.clear();
+    d_->dirty_items.clear();
+    removeAutosaveFiles(d_->directory);
+
+    d_->snapshot_segment = 0;
+    d_->journal_segment = 1;
+    d_->journal_bytes = 0;
+    QSaveFile snapshot(segmentPath(d_->directory, kSnapshotPrefix, d_->snapshot_segment, kSnapshotSuffix));
+    if (!snapshot.open(QIODevice::WriteOnly) || !d_->model->saveTo(snapshot, FileFormat::MessagePack) || !snapshot.commit()) {
+        TL_LOG_ERROR("Failed to write autosave snapshot. Error: {}", snapshot.errorString().toStdString());
+        return false;
+    }
+    d_->last_header = d_->model->saveHeader();
+
+    d_->journal.setFileName(segmentPath(d_->directory, kJournalPrefix, d_->journal_segment, kJournalSuffix));
+    if (!d_->journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        TL_LOG_ERROR("Failed to open autosave journal. Error: {}", d_->journal.errorString().toStdString());
+        return false;
+    }
+    return true;
+}
+
+} // namespace tl
\ No newline at end of file
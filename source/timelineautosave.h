@@ -0,0 +1,62 @@
+#pragma once
+
+#include "timelinedef.h"
+#include "timelinelibexport.h"
+#include <QObject>
+
+namespace tl {
+
+class TimelineModel;
+struct TimelineAutosavePrivate;
+
+// 增量自动保存：模型的修改按发生顺序追加到预写日志，写入量只与修改频率有关。
+// 目录中保存一份快照和若干日志分段，日志超过阈值时在后台线程合并为新快照；
+// 崩溃后用recover()加载快照并重放快照之后的日志。
+// 应在start()之前检查并恢复上次的数据，start()会以当前模型重写快照并清除旧日志。
+class TIMELINE_LIB_EXPORT TimelineAutosave : public QObject {
+    Q_OBJECT
+public:
+    explicit TimelineAutosave(TimelineModel* model, const QString& directory, QObject* parent = nullptr);
+    ~TimelineAutosave() noexcept override;
+
+    TimelineModel* model() const;
+    QString directory() const;
+
+    // 修改发生后最多延迟多久写入日志，单位毫秒
+    void setFlushInterval(int msec);
+    int flushInterval() const;
+    // 日志累计超过该字节数时在后台合并为新快照
+    void setCompactThreshold(qint64 bytes);
+    qint64 compactThreshold() const;
+
+    bool start();
+    void stop();
+    bool isActive() const;
+
+    // 立即把待写入的修改追加到日志
+    void flush();
+    // 立即在后台合并日志，已有合并在进行时忽略
+    void compact();
+    // 停止记录并删除目录中的快照和日志，正常保存工程后调用
+    void discard();
+
+    static bool hasRecoveryData(const QString& directory);
+    static bool recover(TimelineModel& model, const QString& directory);
+
+signals:
+    void compactFinished(bool ok);
+
+private:
+    void onItemChanged(ItemID item_id, int role);
+    void onItemRemoved(ItemID item_id);
+    void onItemConnChanged(const ItemConnID& conn_id, bool created);
+    void markItemDirty(ItemID item_id);
+    void scheduleFlush();
+    void waitForCompaction();
+    bool writeBaseline();
+
+private:
+    TimelineAutosavePrivate* d_ { nullptr };
+};
+
+} // namespace tl
\ No newline at end of file
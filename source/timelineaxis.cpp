@@ -32,6 +32,8 @@ struct TimelineAxisPrivate {
     bool pressed { false };
 
     qint64 value_bak_ { 0 };
+    // 最近一次通知的帧
+    qint64 notified_frame { 0 };
 };
 
 TimelineAxis::TimelineAxis(TimelineView* view)
@@ -41,6 +43,7 @@ TimelineAxis::TimelineAxis(TimelineView* view)
     d_->view = view;
     d_->ruler.tick_width = maxTickLabelWidth();
     d_->ruler.frame_width = innerWidth() / static_cast<qreal>(frameCount());
+    d_->notified_frame = frame();
     setMouseTracking(true);
 }
 
@@ -81,6 +84,7 @@ void TimelineAxis::resizeEvent(QResizeEvent* event)
 {
     QWidget::resizeEvent(event);
     updateTickWidth();
+    notifyFrameChanged();
 }
 
 void TimelineAxis::paintEvent(QPaintEvent* event)
@@ -167,10 +171,9 @@ bool TimelineAxis::handleMousePressEvent(QMouseEvent* event)
     if (QRectF(0, 0, width(), d_->playhead.height).contains(event->position())) {
         d_->pressed = true;
         updatePlayheadX(event->position().x() - d_->ruler.margins.left());
+        emit playheadPressed(frame());
     }
 
-    emit playheadPressed(frame());
-
     return false;
 }
 
@@ -209,12 +212,34 @@ void TimelineAxis::updatePlayheadX(qreal x, bool force)
     if (qFuzzyCompare(x, d_->playhead.x)) {
         if (force) {
             d_->playhead.x = x;
-            update(x, 0, frameWidth(), height());
+            update(playheadRect(x));
         }
         return;
     }
+    const qreal old_x = d_->playhead.x;
     d_->playhead.x = x;
-    update();
+    update(playheadRect(old_x));
+    update(playheadRect(x));
+    notifyFrameChanged();
+}
+
+void TimelineAxis::notifyFrameChanged()
+{
+    const qint64 frame_no = frame();
+    if (frame_no == d_->notified_frame) {
+        return;
+    }
+    d_->notified_frame = frame_no;
+    emit frameChanged(frame_no);
+}
+
+QRect TimelineAxis::playheadRect(qreal playhead_x) const
+{
+    // 覆盖播放头竖条、红色头部以及两侧可能出现的帧号标签
+    qreal x = playhead_x + d_->ruler.margins.left();
+    qreal head_w = qMax(frameWidth(), 20.0);
+    qreal label_w = maxTickLabelWidth() + 4;
+    return QRectF(x - head_w - label_w, 0, 2 * (head_w + label_w) + qMax(frameWidth(), 2.0), height()).toAlignedRect();
 }
 
 void TimelineAxis::updateRulerArea()
@@ -247,6 +272,7 @@ void TimelineAxis::setMaximum(qint64 value)
     d_->ruler.maximum = value;
     updateTickWidth();
     update();
+    notifyFrameChanged();
 }
 
 void TimelineAxis::setMinimum(qint64 value)
@@ -257,6 +283,7 @@ void TimelineAxis::setMinimum(qint64 value)
     d_->ruler.minimum = value;
     updateTickWidth();
     update();
+    notifyFrameChanged();
 }
 
 qreal TimelineAxis::innerWidth() const
@@ -360,8 +387,11 @@ void TimelineAxis::movePlayhead(qint64 frame_no)
     if (qFuzzyCompare(x, d_->playhead.x)) {
         return;
     }
+    const qreal old_x = d_->playhead.x;
     d_->playhead.x = x;
-    update();
+    update(playheadRect(old_x));
+    update(playheadRect(x));
+    notifyFrameChanged();
 }
 
 void TimelineAxis::backupValue()
@@ -40,6 +40,8 @@ public:
 signals:
     void playheadPressed(qint64 frame_no);
     void playheadReleased(qint64 frame_no);
+    // 播放头所在帧变化，包括拖动、movePlayhead()以及范围或宽度变化引起的变化
+    void frameChanged(qint64 frame_no);
 
 protected:
     bool event(QEvent* event) override;
@@ -56,6 +58,8 @@ private:
     void drawRuler(QPainter& painter);
 
     void updatePlayheadX(qreal x, bool force = false);
+    void notifyFrameChanged();
+    QRect playheadRect(qreal playhead_x) const;
     void updateRulerArea();
 
     qreal innerWidth() const;
@@ -0,0 +1,310 @@
+#include "timelinecolumnarstore.h"
+#include <QFileInfo>
+#include <QIODevice>
+#include <algorithm>
+#include <cstring>
+
+namespace tl {
+
+namespace {
+constexpr quint64 kAlignment = 8;
+
+bool isAligned(quint64 offset)
+{
+    return offset % kAlignment == 0;
+}
+} // namespace
+
+std::unique_ptr<TimelineColumnarStore> TimelineColumnarStore::open(const QString& file_path)
+{
+    std::unique_ptr<TimelineColumnarStore> store(new TimelineColumnarStore);
+    auto fail = [&file_path](const char* reason) {
+        TL_LOG_ERROR("Failed to open columnar project {}. Error: {}", file_path.toStdString(), reason);
+        return nullptr;
+    };
+
+    store->file_.setFileName(QFileInfo(file_path).absoluteFilePath());
+    if (!store->file_.open(QIODevice::ReadOnly)) {
+        return fail("cannot open file");
+    }
+    const quint64 file_size = static_cast<quint64>(store->file_.size());
+    if (file_size < sizeof(TimelineColumnar::FileHeader)) {
+        return fail("file too small");
+    }
+    store->data_ = store->file_.map(0, store->file_.size());
+    if (!store->data_) {
+        return fail("cannot map file");
+    }
+
+    TimelineColumnar::FileHeader file_header;
+    std::memcpy(&file_header, store->data_, sizeof(file_header));
+    if (std::memcmp(file_header.magic, TimelineColumnar::kMagic, sizeof(file_header.magic)) != 0) {
+        return fail("bad magic");
+    }
+    if (file_header.version != TimelineColumnar::kVersion) {
+        return fail("unsupported version");
+    }
+    if (!isAligned(file_header.meta_offset) || file_header.meta_offset > file_size || file_header.meta_size > file_size - file_header.meta_offset) {
+        return fail("bad meta block");
+    }
+
+    // 在元数据块内顺序读取，每次读取前检查边界
+    quint64 cursor = file_header.meta_offset;
+    const quint64 meta_end = file_header.meta_offset + file_header.meta_size;
+    auto take = [&](quint64 count, quint64 element_size) -> const uchar* {
+        if (element_size != 0 && count > (meta_end - cursor) / element_size) {
+            return nullptr;
+        }
+        const uchar* result = store->data_ + cursor;
+        cursor += count * element_size;
+        return result;
+    };
+    auto take_count = [&](quint64& count) {
+        const uchar* ptr = take(1, sizeof(quint64));
+        if (!ptr) {
+            return false;
+        }
+        std::memcpy(&count, ptr, sizeof(count));
+        return true;
+    };
+
+    const auto* row_entries = reinterpret_cast<const TimelineColumnar::RowEntry*>(take(file_header.row_count, sizeof(TimelineColumnar::RowEntry)));
+    if (!row_entries) {
+        return fail("bad row directory");
+    }
+    for (quint32 i = 0; i < file_header.row_count; ++i) {
+        const auto& entry = row_entries[i];
+        // starts、durations、ids、payload_offsets四列
+        const quint64 max_count = (file_size / sizeof(quint64) - 1) / 4;
+        if (!isAligned(entry.block_offset) || entry.count > max_count) {
+            return fail("bad row entry");
+        }
+        const quint64 columns_size = (entry.count * 4 + 1) * sizeof(quint64);
+        if (entry.block_offset > file_size || columns_size > file_size - entry.block_offset
+            || entry.payload_size > file_size - entry.block_offset - columns_size) {
+            return fail("row block out of range");
+        }
+
+        Row row;
+        row.row = entry.row;
+        row.count = static_cast<std::size_t>(entry.count);
+        const uchar* block = store->data_ + entry.block_offset;
+        row.starts = reinterpret_cast<const qint64*>(block);
+        row.durations = row.starts + row.count;
+        row.ids = reinterpret_cast<const ItemID*>(row.durations + row.count);
+        row.payload_offsets = reinterpret_cast<const quint64*>(row.ids + row.count);
+        row.payload = block + columns_size;
+        row.payload_size = entry.payload_size;
+        if (row.payload_offsets[row.count] > row.payload_size) {
+            return fail("bad payload offsets");
+        }
+        store->rows_.emplace_back(row);
+    }
+    std::sort(store->rows_.begin(), store->rows_.end(), [](const Row& lhs, const Row& rhs) { return lhs.row < rhs.row; });
+
+    auto take_conns = [&](std::span<const TimelineColumnar::ConnEntry>& conns) {
+        quint64 count = 0;
+        if (!take_count(count)) {
+            return false;
+        }
+        const auto* entries = reinterpret_cast<const TimelineColumnar::ConnEntry*>(take(count, sizeof(TimelineColumnar::ConnEntry)));
+        if (!entries) {
+            return false;
+        }
+        conns = { entries, static_cast<std::size_t>(count) };
+        return true;
+    };
+    if (!take_conns(store->next_conns_) || !take_conns(store->prev_conns_)) {
+        return fail("bad connection table");
+    }
+
+    quint64 header_size = 0;
+    const uchar* header_data = take_count(header_size) ? take(header_size, 1) : nullptr;
+    if (!header_data) {
+        return fail("bad project header");
+    }
+    try {
+        store->header_ = nlohmann::json::from_msgpack(header_data, header_data + header_size);
+    } catch (const std::exception& excep) {
+        return fail(excep.what());
+    }
+    return store;
+}
+
+TimelineColumnarStore::~TimelineColumnarStore() noexcept
+{
+    if (data_) {
+        file_.unmap(const_cast<uchar*>(data_));
+    }
+}
+
+QString TimelineColumnarStore::filePath() const
+{
+    return file_.fileName();
+}
+
+const nlohmann::json& TimelineColumnarStore::header() const
+{
+    return header_;
+}
+
+const std::vector<TimelineColumnarStore::Row>& TimelineColumnarStore::rows() const
+{
+    return rows_;
+}
+
+const TimelineColumnarStore::Row* TimelineColumnarStore::row(int row) const
+{
+    auto it = std::lower_bound(rows_.begin(), rows_.end(), row, [](const Row& lhs, int rhs) { return lhs.row < rhs; });
+    if (it == rows_.end() || it->row != row) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+std::span<const TimelineColumnar::ConnEntry> TimelineColumnarStore::nextConns() const
+{
+    return next_conns_;
+}
+
+std::span<const TimelineColumnar::ConnEntry> TimelineColumnarStore::prevConns() const
+{
+    return prev_conns_;
+}
+
+std::ptrdiff_t TimelineColumnarStore::indexOf(const Row& row, qint64 start, ItemID item_id)
+{
+    const qint64* it = std::lower_bound(row.starts, row.starts + row.count, start);
+    if (it == row.starts + row.count || *it != start) {
+        return -1;
+    }
+    std::ptrdiff_t index = it - row.starts;
+    if (row.ids[index] != item_id) {
+        return -1;
+    }
+    return index;
+}
+
+std::span<const uchar> TimelineColumnarStore::payload(const Row& row, std::size_t index)
+{
+    if (index >= row.count) {
+        return {};
+    }
+    quint64 begin = row.payload_offsets[index];
+    quint64 end = row.payload_offsets[index + 1];
+    if (begin > end || end > row.payload_size) {
+        return {};
+    }
+    return { row.payload + begin, static_cast<std::size_t>(end - begin) };
+}
+
+TimelineColumnarWriter::TimelineColumnarWriter(QIODevice& device)
+    : device_(device)
+{
+}
+
+bool TimelineColumnarWriter::begin()
+{
+    if (device_.isSequential()) {
+        TL_LOG_ERROR("Columnar project requires a seekable device");
+        return false;
+    }
+    TimelineColumnar::FileHeader file_header {};
+    std::memcpy(file_header.magic, TimelineColumnar::kMagic, sizeof(file_header.magic));
+    file_header.version = TimelineColumnar::kVersion;
+    row_entries_.clear();
+    return write(&file_header, sizeof(file_header));
+}
+
+bool TimelineColumnarWriter::writeRow(int row, std::span<const qint64> starts, std::span<const qint64> durations, std::span<const ItemID> ids, const PayloadFunc& payload)
+{
+    const std::size_t count = starts.size();
+    if (durations.size() != count || ids.size() != count) {
+        return false;
+    }
+
+    TimelineColumnar::RowEntry entry {};
+    entry.row = row;
+    entry.count = count;
+    entry.block_offset = static_cast<quint64>(device_.pos());
+    if (!writeArray(starts) || !writeArray(durations) || !writeArray(ids)) {
+        return false;
+    }
+
+    // 先写占位的偏移列，写完payload后回填
+    std::vector<quint64> offsets(count + 1, 0);
+    const qint64 offsets_pos = device_.pos();
+    if (!writeArray(std::span<const quint64>(offsets))) {
+        return false;
+    }
+    std::vector<std::uint8_t> buffer;
+    quint64 payload_size = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        buffer.clear();
+        if (!payload(i, buffer)) {
+            return false;
+        }
+        offsets[i] = payload_size;
+        if (!write(buffer.data(), static_cast<qint64>(buffer.size()))) {
+            return false;
+        }
+        payload_size += buffer.size();
+    }
+    offsets[count] = payload_size;
+    entry.payload_size = payload_size;
+    if (!pad()) {
+        return false;
+    }
+
+    const qint64 end_pos = device_.pos();
+    if (!device_.seek(offsets_pos) || !writeArray(std::span<const quint64>(offsets)) || !device_.seek(end_pos)) {
+        return false;
+    }
+    row_entries_.emplace_back(entry);
+    return true;
+}
+
+bool TimelineColumnarWriter::finish(std::span<const TimelineColumnar::ConnEntry> next_conns, std::span<const TimelineColumnar::ConnEntry> prev_conns, const nlohmann::json& header)
+{
+    TimelineColumnar::FileHeader file_header {};
+    std::memcpy(file_header.magic, TimelineColumnar::kMagic, sizeof(file_header.magic));
+    file_header.version = TimelineColumnar::kVersion;
+    file_header.row_count = static_cast<quint32>(row_entries_.size());
+    file_header.meta_offset = static_cast<quint64>(device_.pos());
+
+    auto write_conns = [this](std::span<const TimelineColumnar::ConnEntry> conns) {
+        quint64 count = conns.size();
+        return write(&count, sizeof(count)) && writeArray(conns);
+    };
+    std::vector<std::uint8_t> header_data;
+    nlohmann::json::to_msgpack(header, header_data);
+    quint64 header_size = header_data.size();
+    if (!writeArray(std::span<const TimelineColumnar::RowEntry>(row_entries_)) || !write_conns(next_conns) || !write_conns(prev_conns)
+        || !write(&header_size, sizeof(header_size)) || !write(header_data.data(), static_cast<qint64>(header_size)) || !pad()) {
+        return false;
+    }
+
+    file_header.meta_size = static_cast<quint64>(device_.pos()) - file_header.meta_offset;
+    const qint64 end_pos = device_.pos();
+    return device_.seek(0) && write(&file_header, sizeof(file_header)) && device_.seek(end_pos);
+}
+
+bool TimelineColumnarWriter::write(const void* data, qint64 size)
+{
+    if (size == 0) {
+        return true;
+    }
+    return device_.write(static_cast<const char*>(data), size) == size;
+}
+
+bool TimelineColumnarWriter::pad()
+{
+    constexpr char kZeros[kAlignment] = {};
+    const quint64 remainder = static_cast<quint64>(device_.pos()) % kAlignment;
+    if (remainder == 0) {
+        return true;
+    }
+    return write(kZeros, static_cast<qint64>(kAlignment - remainder));
+}
+
+} // namespace tl
\ No newline at end of file
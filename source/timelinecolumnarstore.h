@@ -0,0 +1,120 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+#include "timelinedef.h"
+#include <QFile>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+class QIODevice;
+
+namespace tl {
+
+static_assert(std::endian::native == std::endian::little, "columnar project files are little-endian");
+
+// 列式工程文件，所有字段小端存储并按8字节对齐：
+// FileHeader | 行数据块... | RowEntry[row_count] | next连接 | prev连接 | 工程头
+// 行数据块：starts[n] | durations[n] | ids[n] | payload_offsets[n + 1] | payload
+// 条目类型编码在ItemID中；payload为item->save()的MessagePack编码，偏移相对payload起始位置
+struct TimelineColumnar {
+    constexpr static char kMagic[8] = { 'T', 'L', 'C', 'O', 'L', 'U', 'M', 'N' };
+    constexpr static quint32 kVersion = 1;
+
+    struct FileHeader {
+        char magic[8];
+        quint32 version;
+        quint32 row_count;
+        quint64 meta_offset;
+        quint64 meta_size;
+    };
+
+    struct RowEntry {
+        qint32 row;
+        quint32 reserved;
+        quint64 count;
+        quint64 block_offset;
+        quint64 payload_size;
+    };
+
+    struct ConnEntry {
+        ItemID item_id;
+        ItemID from;
+        ItemID to;
+    };
+};
+
+// 内存映射方式打开的列式工程文件，只读，文件在对象销毁前保持映射
+class TimelineColumnarStore {
+public:
+    struct Row {
+        int row { -1 };
+        std::size_t count { 0 };
+        const qint64* starts { nullptr };
+        const qint64* durations { nullptr };
+        const ItemID* ids { nullptr };
+        const quint64* payload_offsets { nullptr };
+        const uchar* payload { nullptr };
+        quint64 payload_size { 0 };
+    };
+
+    // 校验文件结构并建立映射，失败时返回nullptr并记录错误
+    static std::unique_ptr<TimelineColumnarStore> open(const QString& file_path);
+    ~TimelineColumnarStore() noexcept;
+
+    TimelineColumnarStore(const TimelineColumnarStore&) = delete;
+    TimelineColumnarStore& operator=(const TimelineColumnarStore&) = delete;
+
+    QString filePath() const;
+    const nlohmann::json& header() const;
+    // 按行号升序
+    const std::vector<Row>& rows() const;
+    const Row* row(int row) const;
+    std::span<const TimelineColumnar::ConnEntry> nextConns() const;
+    std::span<const TimelineColumnar::ConnEntry> prevConns() const;
+
+    // 按起始帧二分查找条目在行内的下标，未找到时返回-1
+    static std::ptrdiff_t indexOf(const Row& row, qint64 start, ItemID item_id);
+    // 偏移越界时返回空
+    static std::span<const uchar> payload(const Row& row, std::size_t index);
+
+private:
+    TimelineColumnarStore() = default;
+
+    QFile file_;
+    const uchar* data_ { nullptr };
+    nlohmann::json header_;
+    std::vector<Row> rows_;
+    std::span<const TimelineColumnar::ConnEntry> next_conns_;
+    std::span<const TimelineColumnar::ConnEntry> prev_conns_;
+};
+
+// 顺序写出列式工程文件，设备需要支持seek，用于回填偏移
+class TimelineColumnarWriter {
+public:
+    explicit TimelineColumnarWriter(QIODevice& device);
+
+    // payload回调把第i个条目的数据追加到缓冲区，返回false时中止写出
+    using PayloadFunc = std::function<bool(std::size_t index, std::vector<std::uint8_t>& buffer)>;
+
+    bool begin();
+    bool writeRow(int row, std::span<const qint64> starts, std::span<const qint64> durations, std::span<const ItemID> ids, const PayloadFunc& payload);
+    bool finish(std::span<const TimelineColumnar::ConnEntry> next_conns, std::span<const TimelineColumnar::ConnEntry> prev_conns, const nlohmann::json& header);
+
+private:
+    bool write(const void* data, qint64 size);
+    bool pad();
+
+    template <typename T>
+    bool writeArray(std::span<const T> values)
+    {
+        return write(values.data(), static_cast<qint64>(values.size_bytes()));
+    }
+
+    QIODevice& device_;
+    std::vector<TimelineColumnar::RowEntry> row_entries_;
+};
+
+} // namespace tl
\ No newline at end of file
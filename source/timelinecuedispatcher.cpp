@@ -0,0 +1,401 @@
+#include "timelinecuedispatcher.h"
+#include "item/timelineaimitem.h"
+#include "item/timelinearmitem.h"
+#include "item/timelinefocusitem.h"
+#include "item/timelinetrackitem.h"
+#include "item/timelinezoomitem.h"
+#include "timelinemodel.h"
+#include "timelinespscqueue.h"
+#include "timelinetransport.h"
+#include <QPointer>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace tl {
+
+namespace {
+// 粗等待提前醒来的时间窗口，剩余部分自旋等待以降低抖动
+constexpr auto kSpinWindow = std::chrono::microseconds(500);
+
+struct LoopRange {
+    bool looping { false };
+    qint64 first { 0 };
+    qint64 last { 0 };
+    quint32 seq { 0 };
+};
+} // namespace
+
+struct TimelineCueDispatcherPrivate {
+    explicit TimelineCueDispatcherPrivate(std::size_t capacity)
+        : queue(capacity)
+    {
+    }
+
+    std::vector<TimelineCueDispatcher::Cue> cues;
+    TimelineSpscQueue<TimelineCueDispatcher::Cue> queue;
+
+    TimelineCueDispatcher::Clock::time_point anchor_time;
+    qint64 anchor_frame { 0 };
+    double frames_per_second { 24.0 };
+
+    // 循环范围以顺序锁发布：GUI线程写入，调度线程每次回绕前读取完整快照
+    std::atomic<quint32> loop_seq { 0 };
+    std::atomic<bool> looping { false };
+    std::atomic<qint64> loop_first { 0 };
+    std::atomic<qint64> loop_last { 0 };
+
+    void storeLoopRange(const LoopRange& range)
+    {
+        const quint32 seq = loop_seq.load(std::memory_order_relaxed);
+        loop_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        looping.store(range.looping, std::memory_order_relaxed);
+        loop_first.store(range.first, std::memory_order_relaxed);
+        loop_last.store(range.last, std::memory_order_relaxed);
+        loop_seq.store(seq + 2, std::memory_order_release);
+        // 唤醒调度线程按新的范围重新计算下一个Cue，先经过互斥量避免唤醒丢失
+        {
+            std::lock_guard lock(wait_mutex);
+        }
+        wait_cond.notify_all();
+    }
+
+    LoopRange loadLoopRange() const
+    {
+        LoopRange range;
+        quint32 seq = 0;
+        do {
+            seq = loop_seq.load(std::memory_order_acquire);
+            range.looping = looping.load(std::memory_order_relaxed);
+            range.first = loop_first.load(std::memory_order_relaxed);
+            range.last = loop_last.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq & 1) || seq != loop_seq.load(std::memory_order_relaxed));
+        range.seq = seq;
+        return range;
+    }
+
+    // 播放控制由外部持有，销毁后自动置空
+    QPointer<TimelineTransport> transport;
+    QList<QMetaObject::Connection> transport_connections;
+
+    std::unique_ptr<std::jthread> thread;
+    std::mutex wait_mutex;
+    std::condition_variable_any wait_cond;
+
+    // 只由调度线程写入
+    std::atomic<qint64> jitter_count { 0 };
+    std::atomic<qint64> jitter_sum_ns { 0 };
+    std::atomic<double> jitter_sum_sq_us { 0 };
+    std::atomic<qint64> jitter_min_ns { 0 };
+    std::atomic<qint64> jitter_max_ns { 0 };
+    std::atomic<qint64> overflow_count { 0 };
+    // 运行中的重置请求，由调度线程在下一次记录前清零统计
+    std::atomic<bool> jitter_reset_requested { false };
+
+    void clearJitterStats()
+    {
+        jitter_count.store(0, std::memory_order_relaxed);
+        jitter_sum_ns.store(0, std::memory_order_relaxed);
+        jitter_sum_sq_us.store(0, std::memory_order_relaxed);
+        jitter_min_ns.store(0, std::memory_order_relaxed);
+        jitter_max_ns.store(0, std::memory_order_relaxed);
+        overflow_count.store(0, std::memory_order_relaxed);
+    }
+};
+
+TimelineCueDispatcher::TimelineCueDispatcher(std::size_t queue_capacity)
+    : d_(new TimelineCueDispatcherPrivate(queue_capacity))
+{
+}
+
+TimelineCueDispatcher::~TimelineCueDispatcher() noexcept
+{
+    setTransport(nullptr);
+    stop();
+    delete d_;
+}
+
+void TimelineCueDispatcher::rebuild(const TimelineModel& model)
+{
+    stop();
+    d_->cues.clear();
+
+    for (int row = 0; row < model.rowCount(); ++row) {
+        for (const auto& [start, item_id] : model.rowItemRange(row)) {
+            auto* item = model.item(item_id);
+            if (!item || !item->isEnabled() || model.isItemDisabled(item_id)) {
+                continue;
+            }
+
+            Cue cue;
+            cue.frame = start;
+            cue.item_id = item_id;
+            cue.item_type = item->type();
+            switch (cue.item_type) {
+            case TimelineArmItem::Type: {
+                auto* arm_item = static_cast<TimelineArmItem*>(item);
+                const auto& angles = arm_item->angles();
+                if (angles.size() > kMaxCueValues) {
+                    TL_LOG_WARN("Item[{}] has {} joints, only the first {} are dispatched.", item_id, angles.size(), kMaxCueValues);
+                }
+                cue.value_count = static_cast<int>(std::min<std::size_t>(angles.size(), kMaxCueValues));
+                std::copy_n(angles.begin(), cue.value_count, cue.values.begin());
+                cue.flags = arm_item->isTrackingAim() ? TrackingAimFlag : NoFlag;
+            } break;
+            case TimelineAimItem::Type: {
+                auto* aim_item = static_cast<TimelineAimItem*>(item);
+                cue.values = { aim_item->x(), aim_item->y(), aim_item->z(), aim_item->distance() };
+                cue.value_count = 4;
+            } break;
+            case TimelineTrackItem::Type:
+                cue.values[0] = static_cast<TimelineTrackItem*>(item)->position();
+                cue.value_count = 1;
+                break;
+            case TimelineFocusItem::Type:
+                cue.values[0] = static_cast<TimelineFocusItem*>(item)->value();
+                cue.value_count = 1;
+                break;
+            case TimelineZoomItem::Type:
+                cue.values[0] = static_cast<TimelineZoomItem*>(item)->value();
+                cue.value_count = 1;
+                break;
+            default:
+                // 音视频等条目不产生Cue
+                continue;
+            }
+            d_->cues.emplace_back(cue);
+        }
+    }
+
+    std::stable_sort(d_->cues.begin(), d_->cues.end(), [](const Cue& lhs, const Cue& rhs) { return lhs.frame < rhs.frame; });
+    // 绑定了播放控制时按当前播放状态恢复调度
+    if (d_->transport) {
+        syncTransport();
+    }
+}
+
+std::size_t TimelineCueDispatcher::cueCount() const
+{
+    return d_->cues.size();
+}
+
+void TimelineCueDispatcher::setLoopRange(qint64 first, qint64 last)
+{
+    if (last <= first) {
+        TL_LOG_ERROR("Invalid loop range [{}, {}]", first, last);
+        return;
+    }
+    d_->storeLoopRange({ true, first, last });
+}
+
+void TimelineCueDispatcher::clearLoopRange()
+{
+    d_->storeLoopRange({});
+}
+
+void TimelineCueDispatcher::start(Clock::time_point anchor_time, qint64 anchor_frame, double frames_per_second)
+{
+    stop();
+    if (frames_per_second <= 0) {
+        TL_LOG_ERROR("Invalid dispatch rate {} frames per second", frames_per_second);
+        return;
+    }
+    d_->anchor_time = anchor_time;
+    d_->anchor_frame = anchor_frame;
+    d_->frames_per_second = frames_per_second;
+    d_->thread = std::make_unique<std::jthread>([this](std::stop_token st) { run(st); });
+}
+
+void TimelineCueDispatcher::setTransport(TimelineTransport* transport)
+{
+    if (transport == d_->transport) {
+        return;
+    }
+    for (const auto& connection : d_->transport_connections) {
+        QObject::disconnect(connection);
+    }
+    d_->transport_connections.clear();
+    d_->transport = transport;
+    if (!transport) {
+        return;
+    }
+
+    auto sync = [this] { syncTransport(); };
+    auto sync_loop_range = [this] {
+        if (d_->transport && d_->transport->isLooping()) {
+            setLoopRange(d_->transport->loopFirst(), d_->transport->loopLast());
+        } else {
+            clearLoopRange();
+        }
+    };
+    d_->transport_connections = {
+        QObject::connect(transport, &TimelineTransport::anchorChanged, sync),
+        QObject::connect(transport, &TimelineTransport::playingChanged, sync),
+        QObject::connect(transport, &TimelineTransport::loopRangeChanged, sync_loop_range),
+        QObject::connect(transport, &QObject::destroyed, [this] { stop(); }),
+    };
+    sync_loop_range();
+    syncTransport();
+}
+
+TimelineTransport* TimelineCueDispatcher::transport() const
+{
+    return d_->transport;
+}
+
+void TimelineCueDispatcher::syncTransport()
+{
+    auto* transport = d_->transport.data();
+    if (!transport || !transport->isPlaying()) {
+        stop();
+        return;
+    }
+    const double frames_per_second = transport->model()->fps() * transport->rate();
+    // 开始播放时锚点和播放状态先后通知，锚点未变时不必重启调度线程
+    if (isRunning() && d_->anchor_time == transport->anchorTime() && d_->anchor_frame == transport->anchorFrame()
+        && d_->frames_per_second == frames_per_second) {
+        return;
+    }
+    start(transport->anchorTime(), transport->anchorFrame(), frames_per_second);
+}
+
+void TimelineCueDispatcher::stop()
+{
+    if (!d_->thread) {
+        return;
+    }
+    d_->thread->request_stop();
+    d_->wait_cond.notify_all();
+    d_->thread->join();
+    d_->thread.reset();
+    // 调度线程未处理的重置请求在这里完成
+    if (d_->jitter_reset_requested.exchange(false, std::memory_order_acquire)) {
+        d_->clearJitterStats();
+    }
+}
+
+bool TimelineCueDispatcher::isRunning() const
+{
+    return d_->thread != nullptr;
+}
+
+bool TimelineCueDispatcher::tryPop(Cue& cue)
+{
+    return d_->queue.tryPop(cue);
+}
+
+TimelineCueDispatcher::JitterStats TimelineCueDispatcher::jitterStats() const
+{
+    JitterStats stats;
+    if (d_->jitter_reset_requested.load(std::memory_order_acquire)) {
+        return stats;
+    }
+    stats.count = d_->jitter_count.load(std::memory_order_relaxed);
+    stats.overflow_count = d_->overflow_count.load(std::memory_order_relaxed);
+    if (stats.count == 0) {
+        return stats;
+    }
+    stats.mean_us = d_->jitter_sum_ns.load(std::memory_order_relaxed) / 1000.0 / stats.count;
+    double variance = d_->jitter_sum_sq_us.load(std::memory_order_relaxed) / stats.count - stats.mean_us * stats.mean_us;
+    stats.stddev_us = std::sqrt(std::max(0.0, variance));
+    stats.min_us = d_->jitter_min_ns.load(std::memory_order_relaxed) / 1000.0;
+    stats.max_us = d_->jitter_max_ns.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+void TimelineCueDispatcher::resetJitterStats()
+{
+    // 统计只由调度线程写入，运行中交给它清零，避免与正在进行的更新交错
+    if (isRunning()) {
+        d_->jitter_reset_requested.store(true, std::memory_order_release);
+        return;
+    }
+    d_->jitter_reset_requested.store(false, std::memory_order_relaxed);
+    d_->clearJitterStats();
+}
+
+void TimelineCueDispatcher::run(std::stop_token st)
+{
+    const auto& cues = d_->cues;
+    const auto frame_less = [](const Cue& cue, qint64 frame_no) { return cue.frame < frame_no; };
+    qint64 anchor_frame = d_->anchor_frame;
+
+    auto it = std::lower_bound(cues.begin(), cues.end(), anchor_frame, frame_less);
+    while (!st.stop_requested()) {
+        // 循环范围可能在运行中修改，每次都取最新快照
+        const LoopRange loop = d_->loadLoopRange();
+        if (loop.looping && (it == cues.end() || it->frame > loop.last)) {
+            // 与TimelineTransport一致：回绕时锚点帧后移一个循环长度
+            anchor_frame -= loop.last - loop.first + 1;
+            it = std::lower_bound(cues.begin(), cues.end(), loop.first, frame_less);
+            if (it == cues.end() || it->frame > loop.last) {
+                break;
+            }
+        }
+        if (it == cues.end()) {
+            break;
+        }
+
+        const double secs = static_cast<double>(it->frame - anchor_frame) / d_->frames_per_second;
+        const auto deadline = d_->anchor_time + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(secs));
+        if (!waitUntil(deadline, st, loop.seq)) {
+            if (st.stop_requested()) {
+                break;
+            }
+            continue;
+        }
+
+        Cue cue = *it;
+        cue.deadline = deadline;
+        cue.dispatched = Clock::now();
+        recordJitter(cue.dispatched - deadline);
+        if (!d_->queue.tryPush(cue)) {
+            d_->overflow_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        ++it;
+    }
+}
+
+bool TimelineCueDispatcher::waitUntil(Clock::time_point deadline, const std::stop_token& st, quint32 loop_seq)
+{
+    auto loop_changed = [this, loop_seq] { return d_->loop_seq.load(std::memory_order_acquire) != loop_seq; };
+    if (Clock::now() + kSpinWindow < deadline) {
+        std::unique_lock lock(d_->wait_mutex);
+        if (d_->wait_cond.wait_until(lock, st, deadline - kSpinWindow, loop_changed) || st.stop_requested()) {
+            return false;
+        }
+    }
+    while (Clock::now() < deadline) {
+        if (st.stop_requested() || loop_changed()) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return !st.stop_requested();
+}
+
+void TimelineCueDispatcher::recordJitter(Clock::duration jitter)
+{
+    if (d_->jitter_reset_requested.exchange(false, std::memory_order_acquire)) {
+        d_->clearJitterStats();
+    }
+    const qint64 jitter_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(jitter).count();
+    const qint64 count = d_->jitter_count.load(std::memory_order_relaxed);
+    if (count == 0 || jitter_ns < d_->jitter_min_ns.load(std::memory_order_relaxed)) {
+        d_->jitter_min_ns.store(jitter_ns, std::memory_order_relaxed);
+    }
+    if (count == 0 || jitter_ns > d_->jitter_max_ns.load(std::memory_order_relaxed)) {
+        d_->jitter_max_ns.store(jitter_ns, std::memory_order_relaxed);
+    }
+    const double jitter_us = jitter_ns / 1000.0;
+    d_->jitter_sum_ns.fetch_add(jitter_ns, std::memory_order_relaxed);
+    d_->jitter_sum_sq_us.store(d_->jitter_sum_sq_us.load(std::memory_order_relaxed) + jitter_us * jitter_us, std::memory_order_relaxed);
+    d_->jitter_count.store(count + 1, std::memory_order_relaxed);
+}
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "timelinedef.h"
+#include "timelinelibexport.h"
+#include <array>
+#include <chrono>
+#include <stop_token>
+
+namespace tl {
+
+class TimelineModel;
+class TimelineTransport;
+struct TimelineCueDispatcherPrivate;
+
+// 播放期间按帧时间把Arm/Aim/Track/Focus/Zoom等条目的负载实时推送给控制线程。
+// 调度线程不访问QObject，也不发射信号；消费线程通过tryPop()取出Cue。
+class TIMELINE_LIB_EXPORT TimelineCueDispatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+    constexpr static int kMaxCueValues = 16;
+
+    enum CueFlag : int {
+        NoFlag = 0x00,
+        TrackingAimFlag = 0x01,
+    };
+
+    struct Cue {
+        qint64 frame { 0 };
+        ItemID item_id { kInvalidItemID };
+        int item_type { 0 };
+        int flags { NoFlag };
+        // Arm: 关节角度；Aim: x, y, z, distance；Track: position；Focus/Zoom: value
+        int value_count { 0 };
+        std::array<double, kMaxCueValues> values {};
+        // 调度线程计划推送时刻与实际推送时刻
+        Clock::time_point deadline;
+        Clock::time_point dispatched;
+    };
+
+    struct JitterStats {
+        qint64 count { 0 };
+        qint64 overflow_count { 0 };
+        double mean_us { 0 };
+        double stddev_us { 0 };
+        double min_us { 0 };
+        double max_us { 0 };
+    };
+
+    explicit TimelineCueDispatcher(std::size_t queue_capacity = 4096);
+    ~TimelineCueDispatcher() noexcept;
+
+    // 在GUI线程中从模型所有行预计算按时间排序的Cue列表，运行中调用会先停止调度，绑定了播放控制时随后按其状态恢复
+    void rebuild(const TimelineModel& model);
+    std::size_t cueCount() const;
+
+    // 运行中也可以修改，调度线程立即按新的范围计算下一个Cue；仅允许一个线程调用
+    void setLoopRange(qint64 first, qint64 last);
+    void clearLoopRange();
+
+    // anchor_time时刻对应anchor_frame帧，frames_per_second为fps与播放速率之积，与TimelineTransport的锚点保持一致
+    void start(Clock::time_point anchor_time, qint64 anchor_frame, double frames_per_second);
+    // 跟随播放控制：播放时按其锚点启动调度，锚点改变时重新启动，暂停时停止，并同步循环范围；nullptr解除绑定
+    void setTransport(TimelineTransport* transport);
+    TimelineTransport* transport() const;
+    void stop();
+    bool isRunning() const;
+
+    // 仅允许一个消费线程调用
+    bool tryPop(Cue& cue);
+
+    JitterStats jitterStats() const;
+    void resetJitterStats();
+
+private:
+    void syncTransport();
+    void run(std::stop_token st);
+    // 到达deadline时返回true，停止或循环范围改变时提前返回false
+    bool waitUntil(Clock::time_point deadline, const std::stop_token& st, quint32 loop_seq);
+    void recordJitter(Clock::duration jitter);
+
+private:
+    TimelineCueDispatcherPrivate* d_ { nullptr };
+};
+
+} // namespace tl
\ No newline at end of file
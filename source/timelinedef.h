@@ -38,6 +38,14 @@ enum class FrameFormat {
     TimeString
 };
 
+// 工程文件编码格式，Auto表示加载时根据数据头部自动识别
+enum class FileFormat {
+    Auto = 0,
+    Json,
+    Cbor,
+    MessagePack
+};
+
 } // namespace tl
 
 #ifndef TL_LOG_ERROR
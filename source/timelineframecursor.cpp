@@ -0,0 +1,72 @@
+#include "timelineframecursor.h"
+#include "item/timelineitem.h"
+#include "timelinemodel.h"
+#include <algorithm>
+
+namespace tl {
+
+TimelineFrameCursor::TimelineFrameCursor(const TimelineModel* model)
+    : model_(model)
+{
+    auto invalidate = [this] { valid_ = false; };
+    auto invalidate_on_role = [this](int role) {
+        if (role & (TimelineItem::StartRole | TimelineItem::DurationRole)) {
+            valid_ = false;
+        }
+    };
+    connections_ = {
+        QObject::connect(model, &TimelineModel::itemCreated, invalidate),
+        QObject::connect(model, &TimelineModel::itemRemoved, invalidate),
+        QObject::connect(model, &TimelineModel::itemsCreated, invalidate),
+        QObject::connect(model, &TimelineModel::itemsRemoved, invalidate),
+        QObject::connect(model, &TimelineModel::itemChanged, [invalidate_on_role](ItemID, int role) { invalidate_on_role(role); }),
+        QObject::connect(model, &TimelineModel::itemsChanged, [invalidate_on_role](const QList<ItemID>&, int role) { invalidate_on_role(role); }),
+        QObject::connect(model, &TimelineModel::rowCountChanged, invalidate),
+        QObject::connect(model, &TimelineModel::modelReset, invalidate),
+    };
+}
+
+TimelineFrameCursor::~TimelineFrameCursor() noexcept
+{
+    for (const auto& connection : connections_) {
+        QObject::disconnect(connection);
+    }
+}
+
+const std::vector<ItemID>& TimelineFrameCursor::seek(qint64 frame_no)
+{
+    const int row_count = std::max(model_->rowCount(), 0);
+    if (!valid_ || frame_no < frame_ || items_.size() != static_cast<std::size_t>(row_count)) {
+        items_.assign(row_count, kInvalidItemID);
+        next_changes_.assign(row_count, 0);
+        for (int row = 0; row < row_count; ++row) {
+            items_[row] = model_->itemAtFrame(row, frame_no, &next_changes_[row]);
+        }
+        valid_ = true;
+    } else {
+        for (int row = 0; row < row_count; ++row) {
+            if (frame_no >= next_changes_[row]) {
+                items_[row] = model_->itemAtFrame(row, frame_no, &next_changes_[row]);
+            }
+        }
+    }
+    frame_ = frame_no;
+    return items_;
+}
+
+const std::vector<ItemID>& TimelineFrameCursor::items() const
+{
+    return items_;
+}
+
+qint64 TimelineFrameCursor::frame() const
+{
+    return frame_;
+}
+
+void TimelineFrameCursor::invalidate()
+{
+    valid_ = false;
+}
+
+} // namespace tl
\ No newline at end of file
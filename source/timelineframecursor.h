@@ -0,0 +1,39 @@
+#pragma once
+
+#include "timelinedef.h"
+#include "timelinelibexport.h"
+#include <QList>
+#include <QMetaObject>
+#include <vector>
+
+namespace tl {
+
+class TimelineModel;
+
+// 播放头游标：记录各行在当前帧的条目以及结果可能改变的下一帧。
+// 向后移动时只重新查找跨过条目边界的行，向前移动或模型中的条目变化后整体重新查找
+class TIMELINE_LIB_EXPORT TimelineFrameCursor {
+public:
+    explicit TimelineFrameCursor(const TimelineModel* model);
+    ~TimelineFrameCursor() noexcept;
+
+    TimelineFrameCursor(const TimelineFrameCursor&) = delete;
+    TimelineFrameCursor& operator=(const TimelineFrameCursor&) = delete;
+
+    // 移动到frame_no，返回各行的条目，下标为行号，没有条目的行为kInvalidItemID
+    const std::vector<ItemID>& seek(qint64 frame_no);
+    const std::vector<ItemID>& items() const;
+    qint64 frame() const;
+    // 下一次seek()时整体重新查找
+    void invalidate();
+
+private:
+    const TimelineModel* model_ { nullptr };
+    std::vector<ItemID> items_;
+    std::vector<qint64> next_changes_;
+    qint64 frame_ { -1 };
+    bool valid_ { false };
+    QList<QMetaObject::Connection> connections_;
+};
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "timelinegapindex.h"
+#include <algorithm>
+#include <limits>
+
+namespace tl {
+
+namespace {
+// 行首条目的空位，比任何查询需要的帧数都小
+constexpr qint64 kNoGap = std::numeric_limits<qint64>::min();
+} // namespace
+
+void TimelineGapIndex::clear()
+{
+    nodes_.clear();
+    free_nodes_.clear();
+    starts_.clear();
+    root_ = -1;
+}
+
+bool TimelineGapIndex::empty() const
+{
+    return root_ < 0;
+}
+
+std::size_t TimelineGapIndex::size() const
+{
+    return starts_.size();
+}
+
+void TimelineGapIndex::insert(ItemID item_id, qint64 start, qint64 end)
+{
+    if (starts_.contains(item_id)) {
+        remove(item_id);
+    }
+    int node = allocate(item_id, start, end);
+    auto [left, right] = split(root_, start, item_id);
+    // 左侧子树互不重叠，最大结束帧即前一个条目的结束帧
+    nodes_[node].gap = left >= 0 ? start - nodes_[left].max_end - 1 : kNoGap;
+    pull(node);
+    updateFirstGap(right, true, end);
+    root_ = merge(merge(left, node), right);
+    starts_[item_id] = start;
+}
+
+void TimelineGapIndex::remove(ItemID item_id)
+{
+    auto it = starts_.find(item_id);
+    if (it == starts_.end()) {
+        return;
+    }
+    auto [left, rest] = split(root_, it->second, item_id);
+    auto [node, right] = split(rest, it->second, item_id + 1);
+    if (node >= 0) {
+        free_nodes_.emplace_back(node);
+    }
+    updateFirstGap(right, left >= 0, left >= 0 ? nodes_[left].max_end : 0);
+    root_ = merge(left, right);
+    starts_.erase(it);
+}
+
+qint64 TimelineGapIndex::findFirstFreeSlot(qint64 from, qint64 duration) const
+{
+    // [start, start + duration]需要duration + 1个空帧
+    const qint64 need = duration + 1;
+    qint64 slot = from;
+    if (int prev = floorNode(from); prev >= 0) {
+        slot = std::max(from, nodes_[prev].end + 1);
+    }
+    int next = higherNode(from);
+    if (next < 0 || nodes_[next].start - slot >= need) {
+        return slot;
+    }
+    if (int node = findGap(root_, nodes_[next].start, need); node >= 0) {
+        return nodes_[node].start - nodes_[node].gap;
+    }
+    return nodes_[root_].max_end + 1;
+}
+
+std::pair<qint64, qint64> TimelineGapIndex::largestGap(qint64 first, qint64 last) const
+{
+    if (first > last) {
+        return { first, 0 };
+    }
+    qint64 slot = first;
+    if (int prev = floorNode(first); prev >= 0) {
+        slot = std::max(first, nodes_[prev].end + 1);
+    }
+    int next = higherNode(first);
+    if (next < 0 || nodes_[next].start > last) {
+        return slot <= last ? std::pair { slot, last - slot + 1 } : std::pair { first, qint64(0) };
+    }
+
+    // 区间两端的空位被截断，单独计算；中间的空位都完整落在区间内
+    qint64 best_gap = std::max(nodes_[next].start - slot, qint64(0));
+    qint64 best_start = best_gap > 0 ? slot : first;
+    rangeMaxGap(root_, nodes_[next].start, last, best_gap, best_start);
+    if (int tail = floorNode(last); tail >= 0 && last - nodes_[tail].end > best_gap) {
+        best_gap = last - nodes_[tail].end;
+        best_start = nodes_[tail].end + 1;
+    }
+    return { best_start, best_gap };
+}
+
+int TimelineGapIndex::allocate(ItemID item_id, qint64 start, qint64 end)
+{
+    // xorshift，只用于平衡treap
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    Node node;
+    node.start = start;
+    node.end = end;
+    node.item_id = item_id;
+    node.priority = seed_;
+    if (!free_nodes_.empty()) {
+        int index = free_nodes_.back();
+        free_nodes_.pop_back();
+        nodes_[index] = node;
+        return index;
+    }
+    nodes_.emplace_back(node);
+    return static_cast<int>(nodes_.size()) - 1;
+}
+
+void TimelineGapIndex::pull(int node)
+{
+    Node& n = nodes_[node];
+    n.min_start = n.left >= 0 ? nodes_[n.left].min_start : n.start;
+    n.max_start = n.right >= 0 ? nodes_[n.right].max_start : n.start;
+    n.max_end = n.end;
+    // 相同大小的空位取最靠前的一个
+    n.max_gap = kNoGap;
+    auto take = [&n](qint64 gap, qint64 gap_start) {
+        if (gap > n.max_gap) {
+            n.max_gap = gap;
+            n.max_gap_start = gap_start;
+        }
+    };
+    if (n.left >= 0) {
+        const Node& left = nodes_[n.left];
+        n.max_end = std::max(n.max_end, left.max_end);
+        take(left.max_gap, left.max_gap_start);
+    }
+    if (n.gap != kNoGap) {
+        take(n.gap, n.start - n.gap);
+    }
+    if (n.right >= 0) {
+        const Node& right = nodes_[n.right];
+        n.max_end = std::max(n.max_end, right.max_end);
+        take(right.max_gap, right.max_gap_start);
+    }
+}
+
+std::pair<int, int> TimelineGapIndex::split(int node, qint64 start, ItemID item_id)
+{
+    if (node < 0) {
+        return { -1, -1 };
+    }
+    Node& n = nodes_[node];
+    if (std::pair { n.start, n.item_id } < std::pair { start, item_id }) {
+        auto [left, right] = split(n.right, start, item_id);
+        nodes_[node].right = left;
+        pull(node);
+        return { node, right };
+    }
+    auto [left, right] = split(n.left, start, item_id);
+    nodes_[node].left = right;
+    pull(node);
+    return { left, node };
+}
+
+int TimelineGapIndex::merge(int left, int right)
+{
+    if (left < 0) {
+        return right;
+    }
+    if (right < 0) {
+        return left;
+    }
+    if (nodes_[left].priority > nodes_[right].priority) {
+        nodes_[left].right = merge(nodes_[left].right, right);
+        pull(left);
+        return left;
+    }
+    nodes_[right].left = merge(left, nodes_[right].left);
+    pull(right);
+    return right;
+}
+
+void TimelineGapIndex::updateFirstGap(int node, bool has_prev, qint64 prev_end)
+{
+    if (node < 0) {
+        return;
+    }
+    Node& n = nodes_[node];
+    if (n.left >= 0) {
+        updateFirstGap(n.left, has_prev, prev_end);
+    } else {
+        n.gap = has_prev ? n.start - prev_end - 1 : kNoGap;
+    }
+    pull(node);
+}
+
+int TimelineGapIndex::floorNode(qint64 frame) const
+{
+    int result = -1;
+    for (int node = root_; node >= 0;) {
+        if (nodes_[node].start <= frame) {
+            result = node;
+            node = nodes_[node].right;
+        } else {
+            node = nodes_[node].left;
+        }
+    }
+    return result;
+}
+
+int TimelineGapIndex::higherNode(qint64 frame) const
+{
+    int result = -1;
+    for (int node = root_; node >= 0;) {
+        if (nodes_[node].start > frame) {
+            result = node;
+            node = nodes_[node].left;
+        } else {
+            node = nodes_[node].right;
+        }
+    }
+    return result;
+}
+
+int TimelineGapIndex::findGap(int node, qint64 after, qint64 need) const
+{
+    if (node < 0 || nodes_[node].max_gap < need) {
+        return -1;
+    }
+    const Node& n = nodes_[node];
+    if (n.start <= after) {
+        return findGap(n.right, after, need);
+    }
+    if (int result = findGap(n.left, after, need); result >= 0) {
+        return result;
+    }
+    if (n.gap != kNoGap && n.gap >= need) {
+        return node;
+    }
+    return findGap(n.right, after, need);
+}
+
+void TimelineGapIndex::rangeMaxGap(int node, qint64 lower, qint64 upper, qint64& best_gap, qint64& best_start) const
+{
+    if (node < 0) {
+        return;
+    }
+    const Node& n = nodes_[node];
+    if (n.max_start <= lower || n.min_start > upper) {
+        return;
+    }
+    if (n.min_start > lower && n.max_start <= upper) {
+        if (n.max_gap > best_gap) {
+            best_gap = n.max_gap;
+            best_start = n.max_gap_start;
+        }
+        return;
+    }
+    rangeMaxGap(n.left, lower, upper, best_gap, best_start);
+    if (n.start > lower && n.start <= upper && n.gap != kNoGap && n.gap > best_gap) {
+        best_gap = n.gap;
+        best_start = n.start - n.gap;
+    }
+    rangeMaxGap(n.right, lower, upper, best_gap, best_start);
+}
+
+} // namespace tl
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "timelinedef.h"
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tl {
+
+// 单行条目的空位索引。条目按起始帧存放在treap中，每个节点记录与前一个条目之间的空帧数，
+// 子树维护最大空位，插入、删除和查询均为O(log n)。条目占用[start, end]闭区间
+class TimelineGapIndex {
+public:
+    void clear();
+    bool empty() const;
+    std::size_t size() const;
+
+    // 条目已存在时更新其位置
+    void insert(ItemID item_id, qint64 start, qint64 end);
+    void remove(ItemID item_id);
+
+    // 不早于from、能放下[start, start + duration]的第一个起始帧
+    qint64 findFirstFreeSlot(qint64 from, qint64 duration) const;
+    // [first, last]内最大的连续空位，返回{起始帧, 帧数}，没有空位时帧数为0
+    std::pair<qint64, qint64> largestGap(qint64 first, qint64 last) const;
+
+private:
+    struct Node {
+        qint64 start { 0 };
+        qint64 end { 0 };
+        ItemID item_id { kInvalidItemID };
+        quint32 priority { 0 };
+        int left { -1 };
+        int right { -1 };
+        // 与前一个条目之间的空帧数，行首条目没有前一个条目
+        qint64 gap { 0 };
+
+        // 子树聚合
+        qint64 min_start { 0 };
+        qint64 max_start { 0 };
+        qint64 max_end { 0 };
+        qint64 max_gap { 0 };
+        qint64 max_gap_start { 0 };
+    };
+
+    int allocate(ItemID item_id, qint64 start, qint64 end);
+    void pull(int node);
+    // 按(start, item_id)拆分，左侧严格小于key
+    std::pair<int, int> split(int node, qint64 start, ItemID item_id);
+    int merge(int left, int right);
+    // 重新计算子树中第一个节点的空位，prev_end为其前一个条目的结束帧
+    void updateFirstGap(int node, bool has_prev, qint64 prev_end);
+
+    // 起始帧不大于frame的最后一个节点
+    int floorNode(qint64 frame) const;
+    // 起始帧大于frame的第一个节点
+    int higherNode(qint64 frame) const;
+    // 起始帧大于after且空位不小于need的第一个节点
+    int findGap(int node, qint64 after, qint64 need) const;
+    // 起始帧在(lower, upper]内的节点的最大空位
+    void rangeMaxGap(int node, qint64 lower, qint64 upper, qint64& best_gap, qint64& best_start) const;
+
+    std::vector<Node> nodes_;
+    std::vector<int> free_nodes_;
+    std::unordered_map<ItemID, qint64> starts_;
+    int root_ { -1 };
+    quint32 seed_ { 0x9E3779B9u };
+};
+
+} // namespace tl
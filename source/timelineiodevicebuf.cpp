@@ -0,0 +1,71 @@
+#include "timelineiodevicebuf.h"
+#include <QIODevice>
+
+namespace tl {
+
+TimelineIODeviceBuf::TimelineIODeviceBuf(QIODevice* device, std::size_t buffer_size)
+    : device_(device)
+    , buffer_size_(buffer_size)
+{
+    setg(nullptr, nullptr, nullptr);
+    setp(nullptr, nullptr);
+}
+
+TimelineIODeviceBuf::~TimelineIODeviceBuf()
+{
+    sync();
+}
+
+TimelineIODeviceBuf::int_type TimelineIODeviceBuf::underflow()
+{
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    if (!device_ || !device_->isReadable()) {
+        return traits_type::eof();
+    }
+    read_buffer_.resize(buffer_size_);
+    qint64 bytes = device_->read(read_buffer_.data(), static_cast<qint64>(read_buffer_.size()));
+    if (bytes <= 0) {
+        return traits_type::eof();
+    }
+    setg(read_buffer_.data(), read_buffer_.data(), read_buffer_.data() + bytes);
+    return traits_type::to_int_type(*gptr());
+}
+
+TimelineIODeviceBuf::int_type TimelineIODeviceBuf::overflow(int_type ch)
+{
+    if (!device_ || !device_->isWritable()) {
+        return traits_type::eof();
+    }
+    if (write_buffer_.empty()) {
+        write_buffer_.resize(buffer_size_);
+        setp(write_buffer_.data(), write_buffer_.data() + write_buffer_.size());
+    } else if (!flushWriteBuffer()) {
+        return traits_type::eof();
+    }
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+int TimelineIODeviceBuf::sync()
+{
+    return flushWriteBuffer() ? 0 : -1;
+}
+
+bool TimelineIODeviceBuf::flushWriteBuffer()
+{
+    const qint64 bytes = pptr() - pbase();
+    if (bytes <= 0) {
+        return true;
+    }
+    const qint64 written = device_->write(pbase(), bytes);
+    setp(write_buffer_.data(), write_buffer_.data() + write_buffer_.size());
+    return written == bytes;
+}
+
+} // namespace tl
\ No newline at end of file
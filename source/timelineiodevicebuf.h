@@ -0,0 +1,34 @@
+#pragma once
+
+#include <streambuf>
+#include <vector>
+
+class QIODevice;
+
+namespace tl {
+
+// 基于QIODevice的带缓冲std::streambuf，用于按流读写工程数据而不整体载入内存
+class TimelineIODeviceBuf : public std::streambuf {
+public:
+    explicit TimelineIODeviceBuf(QIODevice* device, std::size_t buffer_size = 64 * 1024);
+    ~TimelineIODeviceBuf() override;
+
+    TimelineIODeviceBuf(const TimelineIODeviceBuf&) = delete;
+    TimelineIODeviceBuf& operator=(const TimelineIODeviceBuf&) = delete;
+
+protected:
+    int_type underflow() override;
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    bool flushWriteBuffer();
+
+private:
+    QIODevice* device_ { nullptr };
+    std::size_t buffer_size_ { 0 };
+    std::vector<char> read_buffer_;
+    std::vector<char> write_buffer_;
+};
+
+} // namespace tl
\ No newline at end of file
@@ -2,9 +2,22 @@
 #include "item/timelineaudioitem.h"
 #include "item/timelineitem.h"
 #include "item/timelinevideoitem.h"
+#include "timelinecolumnarstore.h"
+#include "timelinegapindex.h"
+#include "timelineiodevicebuf.h"
 #include "timelineitemfactory.h"
+#include "timelineparallel.h"
+#include "timelinesnapindex.h"
+#include "timelinetransaction.h"
 #include "timelineutil.h"
+#include <QBuffer>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QSaveFile>
+#include <istream>
+#include <ostream>
 #include <set>
+#include <unordered_set>
 
 namespace nlohmann {
 void from_json(const nlohmann::json& j, tl::ItemConnID& conn_id)
@@ -22,13 +35,40 @@ void to_json(nlohmann::json& j, const tl::ItemConnID& conn_id)
 
 namespace tl {
 
+namespace {
+// 识别格式时最多跳过的前导空白字节数
+constexpr qint64 kDetectFormatBytes = 256;
+// 条目数少于该值时串行解析，避免线程启动开销
+constexpr std::size_t kParallelLoadThreshold = 512;
+// 流式加载时每批并行解析的条目数
+constexpr std::size_t kLoadBatchSize = 4096;
+
+nlohmann::json::input_format_t toInputFormat(FileFormat format)
+{
+    switch (format) {
+    case FileFormat::Cbor:
+        return nlohmann::json::input_format_t::cbor;
+    case FileFormat::MessagePack:
+        return nlohmann::json::input_format_t::msgpack;
+    default:
+        return nlohmann::json::input_format_t::json;
+    }
+}
+} // namespace
+
 struct TimelineModelPrivate {
     std::map<ItemID, std::unique_ptr<TimelineItem>> items;
     // {row: {start: item_id}}
     std::map<int, std::map<qint64, ItemID>> item_table;
     // {row: {item_id: start}}
     std::map<int, std::unordered_map<ItemID, qint64>> item_table_helper;
+    // 隐藏的行号，与工程文件中的hidden_rows一致
+    std::set<int> hidden_rows;
+    // setTypeHidden()隐藏的类型
     std::set<int> hidden_types;
+    // 每行的显示位置，即该行之前未隐藏的行数；行数或隐藏状态变化后在下一次查询时重建
+    mutable std::vector<int> row_slots;
+    mutable bool row_slots_valid { false };
     std::set<int> locked_types;
     std::set<int> disabled_types;
     std::map<ItemID, ItemConnID> next_conns;
@@ -43,8 +83,70 @@ struct TimelineModelPrivate {
     bool dirty { false };
     qreal item_height { 40 };
     bool in_loading { false };
+
+    // 以列式文件打开时的映射，尚未构造的条目从这里读取
+    std::unique_ptr<TimelineColumnarStore> column_store;
+    // 波纹平移过但尚未构造的条目在列式文件中的起始帧，索引中已是平移后的起始帧
+    std::unordered_map<ItemID, qint64> stored_starts;
+
+    // 批量操作中待发出的通知
+    int batch_depth { 0 };
+    QList<ItemID> batch_created;
+    QList<ItemID> batch_removed;
+    std::map<ItemID, int> batch_changed_roles;
+
+    // 每行的空位索引和全局的吸附边界索引，加载后在第一次查询时建立，之后随条目变化增量更新
+    std::unordered_map<int, TimelineGapIndex> gap_indexes;
+    TimelineSnapIndex snap_index;
+    bool item_indexes_valid { false };
+};
+
+namespace {
+struct StoredItem {
+    const TimelineColumnarStore::Row* row { nullptr };
+    std::size_t index { 0 };
 };
 
+// 已构造的条目以内存为准；尚未构造的条目没有被修改过，索引中的起始帧与文件一致
+std::optional<StoredItem> findStoredItem(const TimelineModelPrivate& d, ItemID item_id)
+{
+    if (!d.column_store || d.items.contains(item_id)) {
+        return std::nullopt;
+    }
+    int row = TimelineModel::itemRow(item_id);
+    auto helper_row_it = d.item_table_helper.find(row);
+    if (helper_row_it == d.item_table_helper.end()) {
+        return std::nullopt;
+    }
+    auto start_it = helper_row_it->second.find(item_id);
+    if (start_it == helper_row_it->second.end()) {
+        return std::nullopt;
+    }
+    const auto* stored_row = d.column_store->row(row);
+    if (!stored_row) {
+        return std::nullopt;
+    }
+    auto moved_it = d.stored_starts.find(item_id);
+    const qint64 stored_start = moved_it == d.stored_starts.end() ? start_it->second : moved_it->second;
+    auto index = TimelineColumnarStore::indexOf(*stored_row, stored_start, item_id);
+    if (index < 0) {
+        return std::nullopt;
+    }
+    return StoredItem { stored_row, static_cast<std::size_t>(index) };
+}
+
+// 解码映射中的条目数据，平移过的条目以索引中的起始帧为准
+nlohmann::json storedItemJson(const TimelineModelPrivate& d, const StoredItem& stored, ItemID item_id)
+{
+    auto payload = TimelineColumnarStore::payload(*stored.row, stored.index);
+    auto j = nlohmann::json::from_msgpack(payload.begin(), payload.end());
+    if (d.stored_starts.contains(item_id)) {
+        j["start"] = d.item_table_helper.at(TimelineModel::itemRow(item_id)).at(item_id);
+    }
+    return j;
+}
+} // namespace
+
 TimelineModel::TimelineModel(QObject* parent)
     : QObject(parent)
     , d_(new TimelineModelPrivate)
@@ -61,11 +163,35 @@ TimelineItem* TimelineModel::item(ItemID item_id) const
 {
     auto it = d_->items.find(item_id);
     if (it == d_->items.end()) {
-        return nullptr;
+        return materializeItem(item_id);
     }
     return it->second.get();
 }
 
+TimelineItem* TimelineModel::materializeItem(ItemID item_id) const
+{
+    auto stored = findStoredItem(*d_, item_id);
+    if (!stored) {
+        return nullptr;
+    }
+    try {
+        auto item = itemFactory()->createItem(item_id, const_cast<TimelineModel*>(this));
+        if (!item || !item->load(storedItemJson(*d_, *stored, item_id))) {
+            TL_LOG_ERROR("Failed to materialize item[{}]", item_id);
+            return nullptr;
+        }
+        // 只是读取不应使工程变脏
+        item->resetDirty();
+        auto* result = item.get();
+        d_->items[item_id] = std::move(item);
+        d_->stored_starts.erase(item_id);
+        return result;
+    } catch (const std::exception& excep) {
+        TL_LOG_ERROR("Failed to materialize item[{}]. Exception: {}", item_id, excep.what());
+    }
+    return nullptr;
+}
+
 TimelineItem* TimelineModel::itemByStart(int row, qint64 start) const
 {
     auto item_id = itemIdByStart(row, start);
@@ -89,7 +215,7 @@ tl::ItemID TimelineModel::itemIdByStart(int row, qint64 start) const
 
 bool TimelineModel::exists(ItemID item_id) const
 {
-    return d_->items.contains(item_id);
+    return d_->items.contains(item_id) || findStoredItem(*d_, item_id).has_value();
 }
 
 bool TimelineModel::isFrameRangeOccupied(int row, qint64 start, qint64 duration, ItemID except_item) const
@@ -189,6 +315,7 @@ ItemID TimelineModel::createItem(int item_type, int row, qint64 start, qint64 du
     d_->dirty = true;
     d_->item_table[row][start] = item_id;
     d_->item_table_helper[row][item_id] = start;
+    indexItemBounds(item_id);
     emit itemCreated(item_id);
 
     if (headItem(row) == item_id) {
@@ -222,6 +349,10 @@ ItemID TimelineModel::createItem(int item_type, int row, qint64 start, qint64 du
 
 void TimelineModel::removeItem(ItemID item_id)
 {
+    // 删除前先构造，保证后续流程只处理内存中的条目
+    if (!item(item_id)) {
+        return;
+    }
     auto item_it = d_->items.find(item_id);
     if (item_it == d_->items.end()) {
         return;
@@ -273,6 +404,7 @@ void TimelineModel::removeItem(ItemID item_id)
             }
         }
     }
+    unindexItemBounds(item_id);
     d_->items.erase(item_it);
     if (new_head != kInvalidItemID) {
         requestItemOperate(new_head, TimelineItem::OperationRole::OpUpdateAsHead);
@@ -283,6 +415,120 @@ void TimelineModel::removeItem(ItemID item_id)
     setDirty();
 }
 
+void TimelineModel::removeItems(const QList<ItemID>& item_ids)
+{
+    // 按行分组，删除前先构造
+    std::map<int, std::vector<ItemID>> row_items;
+    QList<ItemID> removed;
+    std::unordered_set<ItemID> visited;
+    for (ItemID item_id : item_ids) {
+        if (!visited.insert(item_id).second || !item(item_id)) {
+            continue;
+        }
+        int row = itemRow(item_id);
+        auto helper_row_it = d_->item_table_helper.find(row);
+        if (helper_row_it == d_->item_table_helper.end() || !helper_row_it->second.contains(item_id)) {
+            continue;
+        }
+        row_items[row].emplace_back(item_id);
+        removed.append(item_id);
+    }
+    if (removed.isEmpty()) {
+        return;
+    }
+
+    emit itemsAboutToBeRemoved(removed);
+    beginItemBatch();
+    for (const auto& [row, row_item_ids] : row_items) {
+        ItemID old_head = headItem(row);
+        ItemID old_tail = tailItem(row);
+        auto& table = d_->item_table[row];
+        auto& helper = d_->item_table_helper[row];
+
+        for (ItemID item_id : row_item_ids) {
+            removeFrameConn(item_id);
+        }
+        qint64 first_start = std::numeric_limits<qint64>::max();
+        std::vector<qint64> starts;
+        starts.reserve(row_item_ids.size());
+        for (ItemID item_id : row_item_ids) {
+            auto helper_it = helper.find(item_id);
+            first_start = std::min(first_start, helper_it->second);
+            starts.emplace_back(helper_it->second);
+            table.erase(helper_it->second);
+            helper.erase(helper_it);
+            unindexItemBounds(item_id);
+            d_->items.erase(item_id);
+        }
+
+        // 与removeItem()一致，被删除的连续区间两侧的条目重新连接
+        std::set<std::pair<ItemID, ItemID>> links;
+        for (qint64 start : starts) {
+            auto next_it = table.lower_bound(start);
+            if (next_it != table.end() && next_it != table.begin()) {
+                links.emplace(std::prev(next_it)->second, next_it->second);
+            }
+        }
+        for (const auto& [from, to] : links) {
+            createFrameConnection(from, to);
+        }
+
+        if (table.empty()) {
+            d_->item_table.erase(row);
+            d_->item_table_helper.erase(row);
+            continue;
+        }
+        renumberRow(row, first_start);
+        updateRowEnds(row, old_head, old_tail);
+    }
+    d_->batch_removed.append(removed);
+    setDirty();
+    endItemBatch();
+}
+
+qint64 TimelineModel::moveItems(const QList<ItemID>& item_ids, qint64 delta)
+{
+    if (delta == 0) {
+        return 0;
+    }
+    // 平移量受每个条目外侧未参与平移的相邻条目限制，条目顺序不变，无需重新编号和连接
+    const auto [min_delta, max_delta] = groupMoveRange(item_ids);
+    const bool forward = delta > 0;
+    delta = std::clamp(delta, std::min(min_delta, qint64(0)), std::max(max_delta, qint64(0)));
+    if (delta == 0 || (delta > 0) != forward) {
+        return 0;
+    }
+
+    std::unordered_set<ItemID> moving;
+    std::map<int, std::vector<TimelineItem*>> row_items;
+    for (ItemID item_id : item_ids) {
+        if (!moving.insert(item_id).second) {
+            continue;
+        }
+        if (auto* item_ptr = item(item_id)) {
+            row_items[itemRow(item_id)].emplace_back(item_ptr);
+        }
+    }
+
+    beginItemBatch();
+    for (const auto& [row, row_item_ptrs] : row_items) {
+        auto& table = d_->item_table[row];
+        auto& helper = d_->item_table_helper[row];
+        // 先全部移出再放回，参与平移的条目之间不会互相覆盖
+        for (auto* item_ptr : row_item_ptrs) {
+            table.erase(item_ptr->start());
+        }
+        for (auto* item_ptr : row_item_ptrs) {
+            qint64 start = item_ptr->start() + delta;
+            table[start] = item_ptr->itemId();
+            helper[item_ptr->itemId()] = start;
+            item_ptr->setStart(start);
+        }
+    }
+    endItemBatch();
+    return delta;
+}
+
 ItemConnID TimelineModel::previousConnection(ItemID item_id) const
 {
     auto it = d_->prev_conns.find(item_id);
@@ -392,30 +638,36 @@ TimelineItemFactory* TimelineModel::itemFactory() const
     return d_->item_factory.get();
 }
 
-void TimelineModel::setTypeHidden(int row, int type, bool hidden)
+void TimelineModel::setRowHidden(int row, bool hidden)
 {
     if (hidden) {
-        if (d_->hidden_types.contains(type)) {
+        if (d_->hidden_rows.contains(row)) {
             return;
         }
-        d_->hidden_types.emplace(type);
+        d_->hidden_rows.emplace(row);
     } else {
-        if (!d_->hidden_types.contains(type)) {
+        if (!d_->hidden_rows.contains(row)) {
             return;
         }
-        d_->hidden_types.erase(type);
+        d_->hidden_rows.erase(row);
     }
+    d_->row_slots_valid = false;
+    emit rowLayoutChanged(row);
+    setDirty();
+}
 
-    auto it = d_->item_table.find(row);
-    if (it == d_->item_table.end()) {
-        it = d_->item_table.upper_bound(row);
-    }
-    for (; it != d_->item_table.end(); ++it) {
-        for (const auto& [_, item_id] : it->second) {
-            emit requestUpdateItemY(item_id);
-        }
+void TimelineModel::setTypeHidden(int row, int type, bool hidden)
+{
+    const bool type_changed = hidden ? d_->hidden_types.emplace(type).second : d_->hidden_types.erase(type) > 0;
+    setRowHidden(row, hidden);
+    if (type_changed) {
+        setDirty();
     }
-    setDirty();
+}
+
+bool TimelineModel::isTypeHidden(int type) const
+{
+    return d_->hidden_types.contains(type);
 }
 
 bool TimelineModel::isDirty() const
@@ -434,9 +686,9 @@ void TimelineModel::resetDirty()
     std::for_each(d_->items.begin(), d_->items.end(), [](const auto& pair) { pair.second->resetDirty(); });
 }
 
-bool TimelineModel::isTypeHidden(int type) const
+bool TimelineModel::isRowHidden(int row) const
 {
-    return d_->hidden_types.contains(type);
+    return d_->hidden_rows.contains(row);
 }
 
 bool TimelineModel::isItemHidden(ItemID item_id) const
@@ -444,7 +696,7 @@ bool TimelineModel::isItemHidden(ItemID item_id) const
     if (item_id == kInvalidItemID) {
         return true;
     }
-    return d_->hidden_types.contains(itemType(item_id));
+    return isRowHidden(itemRow(item_id)) || isTypeHidden(itemType(item_id));
 }
 
 void TimelineModel::setTypeLocked(int type, bool locked)
@@ -485,12 +737,11 @@ bool TimelineModel::isItemDisabled(ItemID item_id) const
 
 void TimelineModel::setTypeDisabled(int type, bool disabled)
 {
-    if (disabled) {
-        d_->disabled_types.emplace(type);
-    } else {
-        d_->disabled_types.erase(type);
-    }
+    const bool changed = disabled ? d_->disabled_types.emplace(type).second : d_->disabled_types.erase(type) > 0;
     setDirty();
+    if (changed) {
+        emit typeDisabledChanged(type, disabled);
+    }
 }
 void TimelineModel::setRowCount(int row_count)
 {
@@ -498,6 +749,7 @@ void TimelineModel::setRowCount(int row_count)
         return;
     }
     d_->row_count = row_count;
+    d_->row_slots_valid = false;
     emit rowCountChanged(row_count);
 }
 
@@ -534,12 +786,31 @@ qreal TimelineModel::itemY(ItemID item_id) const
     if (item_row < 0 || item_row >= d_->row_count) {
         return -2 * d_->item_height;
     }
-    if (isTypeHidden(itemType(item_id))) {
+    if (isRowHidden(item_row)) {
         return -2 * d_->item_height;
     }
+    return rowY(item_row);
+}
 
-    int hidden_count = std::distance(d_->hidden_types.begin(), d_->hidden_types.lower_bound(item_row));
-    return (item_row - hidden_count) * d_->item_height;
+qreal TimelineModel::rowY(int row) const
+{
+    if (row < 0 || row >= d_->row_count) {
+        return -2 * d_->item_height;
+    }
+    if (!d_->row_slots_valid) {
+        // 与隐藏行集合同步扫描一遍，O(行数 + 隐藏行数)
+        d_->row_slots.resize(d_->row_count);
+        auto hidden_it = d_->hidden_rows.begin();
+        int hidden_count = 0;
+        for (int i = 0; i < d_->row_count; ++i) {
+            for (; hidden_it != d_->hidden_rows.end() && *hidden_it < i; ++hidden_it) {
+                ++hidden_count;
+            }
+            d_->row_slots[i] = i - hidden_count;
+        }
+        d_->row_slots_valid = true;
+    }
+    return d_->row_slots[row] * d_->item_height;
 }
 
 ItemID TimelineModel::headItem(int row) const
@@ -633,11 +904,128 @@ std::map<qint64, ItemID> TimelineModel::rowItems(int row) const
     return row_it->second;
 }
 
+qint64 TimelineModel::itemEnd(ItemID item_id, qint64 start) const
+{
+    // 尚未构造的条目直接读取映射中的时长
+    if (auto stored = findStoredItem(*d_, item_id)) {
+        return start + stored->row->durations[stored->index];
+    }
+    auto* item = this->item(item_id);
+    return item ? item->start() + item->duration() : start;
+}
+
+std::vector<ItemID> TimelineModel::rowItemsInRange(int row, qint64 first, qint64 last) const
+{
+    std::vector<ItemID> result;
+    for (const auto& [_, item_id] : rowItemRange(row, first, last)) {
+        result.emplace_back(item_id);
+    }
+    return result;
+}
+
+TimelineModel::RowItemRange TimelineModel::rowItemRange(int row) const
+{
+    static const std::map<qint64, ItemID> kEmptyRow;
+    auto row_it = d_->item_table.find(row);
+    const auto& items = row_it == d_->item_table.end() ? kEmptyRow : row_it->second;
+    return { items.begin(), items.end() };
+}
+
+TimelineModel::RowItemRange TimelineModel::rowItemRange(int row, qint64 first, qint64 last) const
+{
+    auto items = rowItemRange(row);
+    if (items.empty() || first > last) {
+        return { items.end(), items.end() };
+    }
+    const auto& table = d_->item_table.at(row);
+    auto begin = table.lower_bound(first);
+    // 同一行条目互不重叠，只有前一个条目可能跨过first
+    if (begin != table.begin()) {
+        auto prev_it = std::prev(begin);
+        if (itemEnd(prev_it->second, prev_it->first) >= first) {
+            begin = prev_it;
+        }
+    }
+    return { begin, table.upper_bound(last) };
+}
+
+std::vector<std::pair<qint64, ItemID>> TimelineModel::rowItemsSnapshot(int row, qint64 first, qint64 last) const
+{
+    auto items = rowItemRange(row, first, last);
+    return { items.begin(), items.end() };
+}
+
+ItemID TimelineModel::itemAtFrame(int row, qint64 frame_no, qint64* next_change) const
+{
+    constexpr qint64 kNoChange = std::numeric_limits<qint64>::max();
+    auto row_it = d_->item_table.find(row);
+    if (row_it == d_->item_table.end()) {
+        if (next_change) {
+            *next_change = kNoChange;
+        }
+        return kInvalidItemID;
+    }
+    const auto& table = row_it->second;
+    auto next_it = table.upper_bound(frame_no);
+    const qint64 next_start = next_it == table.end() ? kNoChange : next_it->first;
+    if (next_it != table.begin()) {
+        auto it = std::prev(next_it);
+        const qint64 end = itemEnd(it->second, it->first);
+        if (end >= frame_no) {
+            if (next_change) {
+                *next_change = end == kNoChange ? end : end + 1;
+            }
+            return it->second;
+        }
+    }
+    if (next_change) {
+        *next_change = next_start;
+    }
+    return kInvalidItemID;
+}
+
+std::vector<ItemID> TimelineModel::itemsAtFrame(qint64 frame_no) const
+{
+    std::vector<ItemID> result(std::max(d_->row_count, 0), kInvalidItemID);
+    for (int row = 0; row < d_->row_count; ++row) {
+        result[row] = itemAtFrame(row, frame_no);
+    }
+    return result;
+}
+
+std::vector<ItemID> TimelineModel::itemsAtFrames(std::span<const qint64> frames) const
+{
+    const int row_count = std::max(d_->row_count, 0);
+    std::vector<ItemID> result(frames.size() * row_count, kInvalidItemID);
+    for (int row = 0; row < row_count; ++row) {
+        // 帧号递增且未越过下一个边界时沿用上一帧的结果
+        ItemID item_id = kInvalidItemID;
+        qint64 prev_frame = std::numeric_limits<qint64>::min();
+        qint64 next_change = std::numeric_limits<qint64>::min();
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            const qint64 frame_no = frames[i];
+            if (frame_no < prev_frame || frame_no >= next_change) {
+                item_id = itemAtFrame(row, frame_no, &next_change);
+            }
+            prev_frame = frame_no;
+            result[i * row_count + row] = item_id;
+        }
+    }
+    return result;
+}
+
 void TimelineModel::notifyItemPropertyChanged(ItemID item_id, int role, const QVariant& old_val)
 {
     if (!d_->items.contains(item_id)) {
         return;
     }
+    if (role & (TimelineItem::StartRole | TimelineItem::DurationRole)) {
+        indexItemBounds(item_id);
+    }
+    if (d_->batch_depth > 0) {
+        d_->batch_changed_roles[item_id] |= role;
+        return;
+    }
     emit itemChanged(item_id, role, old_val);
 }
 
@@ -684,6 +1072,19 @@ bool TimelineModel::isFrameInRange(qint64 start, qint64 duration) const
     return start >= d_->view_frame_range[0] && start + duration <= d_->view_frame_range[1];
 }
 
+std::optional<std::pair<qint64, qint64>> TimelineModel::itemFrameRange(ItemID item_id) const
+{
+    if (auto it = d_->items.find(item_id); it != d_->items.end()) {
+        return std::pair { it->second->start(), it->second->start() + it->second->duration() };
+    }
+    auto stored = findStoredItem(*d_, item_id);
+    if (!stored) {
+        return std::nullopt;
+    }
+    const qint64 start = d_->item_table_helper.at(itemRow(item_id)).at(item_id);
+    return std::pair { start, start + stored->row->durations[stored->index] };
+}
+
 bool TimelineModel::isItemInViewRange(ItemID item_id) const
 {
     auto* item = this->item(item_id);
@@ -797,14 +1198,29 @@ qint64 TimelineModel::viewFrameMaximum() const
 
 void TimelineModel::clear()
 {
-    std::set<ItemID> item_ids;
-    std::transform(d_->items.cbegin(), d_->items.cend(), std::inserter(item_ids, item_ids.begin()), [](const auto& pair) { return pair.first; });
-    for (const auto& item_id : item_ids) {
-        removeItem(item_id);
-    }
+    // 整体丢弃，不逐个removeItem，避免重排序号和连接产生的信号级联
+    emit modelAboutToBeReset();
+    resetData();
+    emit modelReset();
+}
+
+void TimelineModel::resetData()
+{
+    d_->prev_conns.clear();
+    d_->next_conns.clear();
+    d_->item_table.clear();
+    d_->item_table_helper.clear();
+    d_->items.clear();
+    d_->column_store.reset();
+    d_->stored_starts.clear();
+    d_->gap_indexes.clear();
+    d_->snap_index.clearItems();
+    d_->item_indexes_valid = false;
     d_->id_index = 0;
     d_->dirty = false;
+    d_->hidden_rows.clear();
     d_->hidden_types.clear();
+    d_->row_slots_valid = false;
     d_->locked_types.clear();
     d_->disabled_types.clear();
 }
@@ -818,38 +1234,30 @@ bool TimelineModel::load(const nlohmann::json& j)
 {
     d_->in_loading = true;
     auto guard = qScopeGuard([this] { d_->in_loading = false; });
+    emit modelAboutToBeReset();
+    resetData();
     try {
-        clear();
         from_json(j, *this);
         return true;
     } catch (const std::exception& excep) {
         TL_LOG_ERROR("Failed to load item. Exception: {}", excep.what());
     }
+    resetData();
+    emit modelReset();
     return false;
 }
 
 nlohmann::json TimelineModel::save() const
 {
-    nlohmann::json j;
-
-    j["id_index"] = d_->id_index;
-    j["row_count"] = d_->row_count;
-    // j["item_table"] = d_->item_table;
-    // j["item_table_helper"] = d_->item_table_helper;
-    j["hidden_rows"] = d_->hidden_types;
-    j["locked_rows"] = d_->locked_types;
-    j["disabled_rows"] = d_->disabled_types;
-    j["frame_range"] = d_->frame_range;
-    j["view_frame_range"] = d_->view_frame_range;
+    nlohmann::json j = saveHeader();
 
     nlohmann::json items_j;
 
     for (const auto& [row, start_map] : d_->item_table) {
         for (const auto& [start, item_id] : start_map) {
-            auto* item_ptr = this->item(item_id);
             nlohmann::json item_j;
             item_j["id"] = item_id;
-            item_j["data"] = item_ptr->save();
+            item_j["data"] = itemData(item_id);
             items_j.emplace_back(item_j);
         }
     }
@@ -875,6 +1283,244 @@ nlohmann::json TimelineModel::save() const
     return j;
 }
 
+QByteArray TimelineModel::saveToData(FileFormat format) const
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!saveTo(buffer, format)) {
+        return {};
+    }
+    return data;
+}
+
+// 按顺序写出JSON/CBOR/MessagePack的容器头和值，各条目单独序列化后立即写入流
+class TimelineModelStreamWriter {
+public:
+    TimelineModelStreamWriter(std::ostream& stream, FileFormat format)
+        : stream_(stream)
+        , format_(format)
+    {
+    }
+
+    void beginObject(std::size_t size)
+    {
+        if (format_ == FileFormat::Json) {
+            separate();
+            stream_.put('{');
+            first_.emplace_back(true);
+        } else {
+            writeHeader(0xA0, 0x80, 0xDE, size);
+        }
+    }
+
+    void endObject()
+    {
+        if (format_ == FileFormat::Json) {
+            first_.pop_back();
+            stream_.put('}');
+        }
+    }
+
+    void beginArray(std::size_t size)
+    {
+        if (format_ == FileFormat::Json) {
+            separate();
+            stream_.put('[');
+            first_.emplace_back(true);
+        } else {
+            writeHeader(0x80, 0x90, 0xDC, size);
+        }
+    }
+
+    void endArray()
+    {
+        if (format_ == FileFormat::Json) {
+            first_.pop_back();
+            stream_.put(']');
+        }
+    }
+
+    void key(const std::string& name)
+    {
+        if (format_ == FileFormat::Json) {
+            separate();
+            stream_ << nlohmann::json(name) << ':';
+            after_key_ = true;
+        } else {
+            value(name);
+        }
+    }
+
+    void value(const nlohmann::json& j)
+    {
+        switch (format_) {
+        case FileFormat::Cbor:
+            nlohmann::json::to_cbor(j, stream_);
+            break;
+        case FileFormat::MessagePack:
+            nlohmann::json::to_msgpack(j, stream_);
+            break;
+        default:
+            separate();
+            stream_ << j;
+            break;
+        }
+    }
+
+private:
+    void separate()
+    {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (!first_.empty()) {
+            if (!first_.back()) {
+                stream_.put(',');
+            }
+            first_.back() = false;
+        }
+    }
+
+    // cbor_major为CBOR主类型的高3位，msgpack_fix/msgpack_16为MessagePack的fix类型前缀和16位长度前缀（32位前缀为其加1）
+    void writeHeader(std::uint8_t cbor_major, std::uint8_t msgpack_fix, std::uint8_t msgpack_16, std::size_t size)
+    {
+        if (format_ == FileFormat::Cbor) {
+            if (size < 24) {
+                stream_.put(static_cast<char>(cbor_major | size));
+            } else if (size <= 0xFF) {
+                stream_.put(static_cast<char>(cbor_major | 24));
+                writeBigEndian(size, 1);
+            } else if (size <= 0xFFFF) {
+                stream_.put(static_cast<char>(cbor_major | 25));
+                writeBigEndian(size, 2);
+            } else if (size <= 0xFFFFFFFF) {
+                stream_.put(static_cast<char>(cbor_major | 26));
+                writeBigEndian(size, 4);
+            } else {
+                stream_.put(static_cast<char>(cbor_major | 27));
+                writeBigEndian(size, 8);
+            }
+            return;
+        }
+
+        if (size < 16) {
+            stream_.put(static_cast<char>(msgpack_fix | size));
+        } else if (size <= 0xFFFF) {
+            stream_.put(static_cast<char>(msgpack_16));
+            writeBigEndian(size, 2);
+        } else {
+            stream_.put(static_cast<char>(msgpack_16 + 1));
+            writeBigEndian(size, 4);
+        }
+    }
+
+    void writeBigEndian(std::uint64_t value, int bytes)
+    {
+        for (int i = bytes - 1; i >= 0; --i) {
+            stream_.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+        }
+    }
+
+private:
+    std::ostream& stream_;
+    FileFormat format_ { FileFormat::Json };
+    // JSON容器栈，记录当前容器是否尚未写入元素
+    std::vector<bool> first_;
+    bool after_key_ { false };
+};
+
+bool TimelineModel::saveTo(QIODevice& device, FileFormat format) const
+{
+    if (!device.isWritable()) {
+        TL_LOG_ERROR("Failed to save project. The device is not writable.");
+        return false;
+    }
+
+    TimelineIODeviceBuf buffer(&device);
+    std::ostream stream(&buffer);
+    TimelineModelStreamWriter writer(stream, format == FileFormat::Auto ? FileFormat::Json : format);
+
+    auto write_conns = [&writer](const std::map<ItemID, ItemConnID>& conns) {
+        writer.beginArray(conns.size());
+        for (const auto& [item_id, conn_id] : conns) {
+            nlohmann::json conn_item_j;
+            conn_item_j["item_id"] = item_id;
+            conn_item_j["connection"] = conn_id;
+            writer.value(conn_item_j);
+        }
+        writer.endArray();
+    };
+
+    // 字段与save()一致，条目与连接放在最后，便于流式加载时先拿到工程头信息
+    writer.beginObject(11);
+    writer.key("id_index");
+    writer.value(d_->id_index);
+    writer.key("row_count");
+    writer.value(d_->row_count);
+    writer.key("hidden_rows");
+    writer.value(d_->hidden_rows);
+    writer.key("hidden_types");
+    writer.value(d_->hidden_types);
+    writer.key("locked_rows");
+    writer.value(d_->locked_types);
+    writer.key("disabled_rows");
+    writer.value(d_->disabled_types);
+    writer.key("frame_range");
+    writer.value(d_->frame_range);
+    writer.key("view_frame_range");
+    writer.value(d_->view_frame_range);
+
+    writer.key("items");
+    std::size_t item_count = 0;
+    for (const auto& [_, start_map] : d_->item_table) {
+        item_count += start_map.size();
+    }
+    writer.beginArray(item_count);
+    for (const auto& [row, start_map] : d_->item_table) {
+        for (const auto& [start, item_id] : start_map) {
+            nlohmann::json item_j;
+            item_j["id"] = item_id;
+            item_j["data"] = itemData(item_id);
+            writer.value(item_j);
+        }
+    }
+    writer.endArray();
+
+    writer.key("prev_conns");
+    write_conns(d_->prev_conns);
+    writer.key("next_conns");
+    write_conns(d_->next_conns);
+    writer.endObject();
+
+    stream.flush();
+    if (!stream.good()) {
+        TL_LOG_ERROR("Failed to save project. Error: {}", device.errorString().toStdString());
+        return false;
+    }
+    return true;
+}
+
+FileFormat TimelineModel::detectFileFormat(const QByteArray& data)
+{
+    // 工程根节点是对象：JSON以'{'开头（允许前导空白），CBOR映射为0xA0~0xBF，MessagePack映射为0x80~0x8F、0xDE、0xDF
+    for (char ch : data) {
+        const auto byte = static_cast<std::uint8_t>(ch);
+        if (byte == ' ' || byte == '\t' || byte == '\r' || byte == '\n') {
+            continue;
+        }
+        if (byte >= 0xA0 && byte <= 0xBF) {
+            return FileFormat::Cbor;
+        }
+        if ((byte >= 0x80 && byte <= 0x8F) || byte == 0xDE || byte == 0xDF) {
+            return FileFormat::MessagePack;
+        }
+        break;
+    }
+    return FileFormat::Json;
+}
+
 QString TimelineModel::copyItem(ItemID item_id) const
 {
     nlohmann::json j = saveItem(item_id);
@@ -904,19 +1550,235 @@ ItemID TimelineModel::pasteItem(const QString& data, qint64 frame_no)
     return kInvalidItemID;
 }
 
-void TimelineModel::loadItem(const nlohmann::json& j, const std::optional<ItemID>& item_id_opt, const std::optional<qint64>& start)
+std::pair<qint64, qint64> TimelineModel::groupMoveRange(const QList<ItemID>& item_ids) const
 {
-    ItemID item_id = item_id_opt.value_or(j["id"]);
-    if (exists(item_id)) {
-        return;
+    std::unordered_set<ItemID> moving(item_ids.begin(), item_ids.end());
+    qint64 min_delta = std::numeric_limits<qint64>::min();
+    qint64 max_delta = std::numeric_limits<qint64>::max();
+    // 每个条目只查看前后两个相邻条目，相邻条目也在组内时不受限制；平移后不能超出[frameMinimum(), frameMaximum()]
+    for (ItemID item_id : moving) {
+        auto* item_ptr = item(item_id);
+        if (!item_ptr) {
+            continue;
+        }
+        min_delta = std::max(min_delta, d_->frame_range[0] - item_ptr->start());
+        max_delta = std::min(max_delta, d_->frame_range[1] - item_ptr->start() - item_ptr->duration());
+        if (ItemID prev_item_id = previousItem(item_id); !moving.contains(prev_item_id)) {
+            if (auto* prev_item = item(prev_item_id)) {
+                min_delta = std::max(min_delta, prev_item->start() + prev_item->duration() + 1 - item_ptr->start());
+            }
+        }
+        if (ItemID next_item_id = nextItem(item_id); !moving.contains(next_item_id)) {
+            if (auto* next_item = item(next_item_id)) {
+                max_delta = std::min(max_delta, next_item->start() - item_ptr->start() - item_ptr->duration() - 1);
+            }
+        }
     }
+    return { min_delta, max_delta };
+}
 
-    int row = itemRow(item_id);
-    auto item = itemFactory()->createItem(item_id, this);
-    if (!item) {
+bool TimelineModel::rippleShift(int row, qint64 from_frame, qint64 delta)
+{
+    if (delta == 0) {
+        return true;
+    }
+    std::vector<int> rows;
+    if (row == kAllRows) {
+        for (const auto& [table_row, _] : d_->item_table) {
+            rows.emplace_back(table_row);
+        }
+    } else if (d_->item_table.contains(row)) {
+        rows.emplace_back(row);
+    }
+
+    // 先检查所有行。平移后的条目不能超出[frameMinimum(), frameMaximum()]
+    for (int table_row : rows) {
+        const auto& table = d_->item_table[table_row];
+        auto first_it = table.lower_bound(from_frame);
+        if (first_it == table.end()) {
+            continue;
+        }
+        auto last_it = std::prev(table.end());
+        if (first_it->first + delta < d_->frame_range[0] || itemEnd(last_it->second, last_it->first) + delta > d_->frame_range[1]) {
+            emit errorOccurred(tr("The frame is out of range!"));
+            return false;
+        }
+    }
+    // 左移时被移除的区间[from_frame + delta, from_frame)内不能有条目起始，
+    // 撤销时以from_frame + delta为界右移，才不会带上原本没有平移的条目；
+    // 第一个被平移的条目也不能与前一个条目重叠
+    if (delta < 0) {
+        for (int table_row : rows) {
+            const auto& table = d_->item_table[table_row];
+            auto first_it = table.lower_bound(from_frame);
+            if (table.lower_bound(from_frame + delta) != first_it) {
+                emit errorOccurred(tr("Another frame already exists in the current location!"));
+                return false;
+            }
+            if (first_it == table.end() || first_it == table.begin()) {
+                continue;
+            }
+            auto prev_it = std::prev(first_it);
+            if (itemEnd(prev_it->second, prev_it->first) >= first_it->first + delta) {
+                emit errorOccurred(tr("Another frame already exists in the current location!"));
+                return false;
+            }
+        }
+    }
+
+    beginItemBatch();
+    for (int table_row : rows) {
+        auto& table = d_->item_table[table_row];
+        auto& helper = d_->item_table_helper[table_row];
+        auto first_it = table.lower_bound(from_frame);
+        if (first_it == table.end()) {
+            continue;
+        }
+        // 平移后的键仍大于其余所有键，摘下尾部节点改键后依次放回末尾，不重新分配节点也不做查找
+        std::vector<std::remove_reference_t<decltype(table)>::node_type> nodes;
+        for (auto it = first_it; it != table.end();) {
+            nodes.emplace_back(table.extract(it++));
+        }
+        for (auto& node : nodes) {
+            const qint64 old_start = node.key();
+            node.key() += delta;
+            auto it = table.insert(table.end(), std::move(node));
+            const ItemID item_id = it->second;
+            auto item_it = d_->items.find(item_id);
+            if (item_it != d_->items.end()) {
+                helper[item_id] = it->first;
+                item_it->second->setStart(it->first);
+                continue;
+            }
+            // 尚未构造的条目不构造，只改键并记下它在列式文件中的起始帧，构造或保存时再应用新位置
+            d_->stored_starts.try_emplace(item_id, old_start);
+            helper[item_id] = it->first;
+            if (d_->item_indexes_valid) {
+                const qint64 end = itemEnd(item_id, it->first);
+                d_->gap_indexes[table_row].insert(item_id, it->first, end);
+                d_->snap_index.insertItem(item_id, it->first, end);
+            }
+            d_->batch_changed_roles[item_id] |= TimelineItem::StartRole;
+        }
+    }
+    setDirty();
+    endItemBatch();
+    return true;
+}
+
+qint64 TimelineModel::findFirstFreeSlot(int row, qint64 from, qint64 duration) const
+{
+    if (row < 0 || row >= d_->row_count) {
+        return -1;
+    }
+    ensureItemIndexes();
+    auto it = d_->gap_indexes.find(row);
+    return it == d_->gap_indexes.end() ? from : it->second.findFirstFreeSlot(from, duration);
+}
+
+std::pair<qint64, qint64> TimelineModel::largestGap(int row, qint64 first, qint64 last) const
+{
+    if (row < 0 || row >= d_->row_count || first > last) {
+        return { first, 0 };
+    }
+    ensureItemIndexes();
+    auto it = d_->gap_indexes.find(row);
+    return it == d_->gap_indexes.end() ? std::pair { first, last - first + 1 } : it->second.largestGap(first, last);
+}
+
+std::optional<TimelineSnapTarget> TimelineModel::nearestSnapTarget(qint64 frame_no, qint64 tolerance, const TimelineSnapFilter& filter) const
+{
+    ensureItemIndexes();
+    return d_->snap_index.nearest(frame_no, tolerance, filter);
+}
+
+void TimelineModel::setSnapPlayhead(qint64 frame_no)
+{
+    d_->snap_index.setPlayhead(frame_no);
+}
+
+void TimelineModel::addSnapMarker(qint64 frame_no)
+{
+    d_->snap_index.addMarker(frame_no);
+}
+
+void TimelineModel::removeSnapMarker(qint64 frame_no)
+{
+    d_->snap_index.removeMarker(frame_no);
+}
+
+void TimelineModel::clearSnapMarkers()
+{
+    d_->snap_index.clearMarkers();
+}
+
+QString TimelineModel::copyItems(const QList<ItemID>& item_ids) const
+{
+    nlohmann::json j = nlohmann::json::array();
+    for (ItemID item_id : item_ids) {
+        if (exists(item_id)) {
+            j.emplace_back(saveItem(item_id));
+        }
+    }
+    return QString::fromStdString(j.dump());
+}
+
+QList<ItemID> TimelineModel::pasteItems(const QString& data, qint64 frame_no)
+{
+    try {
+        auto j = nlohmann::json::parse(data.toStdString());
+        if (!j.is_array() || j.empty()) {
+            return {};
+        }
+
+        std::vector<std::pair<std::unique_ptr<TimelineItem>, bool>> items;
+        items.reserve(j.size());
+        qint64 first_start = std::numeric_limits<qint64>::max();
+        for (const auto& item_j : j) {
+            auto old_item_id = item_j["id"].get<ItemID>();
+            ItemID item_id = makeItemID(itemType(old_item_id), itemRow(old_item_id), d_->id_index + items.size());
+            auto item = itemFactory()->createItem(item_id, this);
+            if (!item || !item->load(item_j["data"])) {
+                TL_LOG_ERROR("Failed to paste item[{}]", old_item_id);
+                return {};
+            }
+            first_start = std::min(first_start, item->start());
+            items.emplace_back(std::move(item), item_j.contains("with_connection") && item_j["with_connection"].get<bool>());
+        }
+
+        QList<ItemID> item_ids;
+        for (auto& [item, with_connection] : items) {
+            item->setStart(item->start() - first_start + frame_no);
+            item_ids.append(item->itemId());
+        }
+        if (!insertItems(std::move(items))) {
+            return {};
+        }
+        d_->id_index += item_ids.size();
+        return item_ids;
+    } catch (const std::exception& excep) {
+        TL_LOG_ERROR("Failed to parse item data. Exception: {}", excep.what());
+    }
+    return {};
+}
+
+void TimelineModel::loadItem(const nlohmann::json& j, const std::optional<ItemID>& item_id_opt, const std::optional<qint64>& start)
+{
+    loadItemData(item_id_opt.value_or(j["id"]), j["data"], j.contains("with_connection") && j["with_connection"].get<bool>(), start);
+}
+
+void TimelineModel::loadItemData(ItemID item_id, const nlohmann::json& data, bool with_connection, const std::optional<qint64>& start)
+{
+    if (exists(item_id)) {
+        return;
+    }
+
+    int row = itemRow(item_id);
+    auto item = itemFactory()->createItem(item_id, this);
+    if (!item) {
         throw std::exception(std::format("create item[{}] failed!", item_id).c_str());
     }
-    if (!item->load(j["data"])) {
+    if (!item->load(data)) {
         throw std::exception(std::format("load item[{}] failed!", item_id).c_str());
     }
 
@@ -961,6 +1823,7 @@ void TimelineModel::loadItem(const nlohmann::json& j, const std::optional<ItemID
     d_->item_table[row][item->start()] = item_id;
     d_->item_table_helper[row][item_id] = item->start();
     d_->items[item_id] = std::move(item);
+    indexItemBounds(item_id);
     emit itemCreated(item_id);
 
     if (headItem(row) == item_id) {
@@ -975,7 +1838,7 @@ void TimelineModel::loadItem(const nlohmann::json& j, const std::optional<ItemID
         requestItemOperate(old_tail, TimelineItem::OperationRole::OpUpdateAsTail);
     }
 
-    if (j.contains("with_connection") && j["with_connection"].get<bool>()) {
+    if (with_connection) {
         // 增加Connection
         auto prev_item_id = previousItem(item_id);
         if (prev_item_id != kInvalidItemID) {
@@ -994,83 +1857,750 @@ void TimelineModel::loadItem(const nlohmann::json& j, const std::optional<ItemID
 nlohmann::json TimelineModel::saveItem(ItemID item_id) const
 {
     nlohmann::json item_j;
-    auto it = d_->items.find(item_id);
-    if (it == d_->items.end()) {
+    if (!exists(item_id)) {
         return item_j;
     }
     item_j["id"] = item_id;
-    item_j["data"] = it->second->save();
+    item_j["data"] = itemData(item_id);
     item_j["with_connection"] = hasConnection(item_id);
     return item_j;
 }
 
+void TimelineModel::ensureItemIndexes() const
+{
+    if (d_->item_indexes_valid) {
+        return;
+    }
+    d_->gap_indexes.clear();
+    d_->snap_index.clearItems();
+    for (const auto& [row, table] : d_->item_table) {
+        auto& gap_index = d_->gap_indexes[row];
+        for (const auto& [start, item_id] : table) {
+            // 尚未构造的条目直接读取映射中的时长
+            qint64 duration = 0;
+            if (auto stored = findStoredItem(*d_, item_id)) {
+                duration = stored->row->durations[stored->index];
+            } else if (auto it = d_->items.find(item_id); it != d_->items.end()) {
+                duration = it->second->duration();
+            }
+            gap_index.insert(item_id, start, start + duration);
+            d_->snap_index.insertItem(item_id, start, start + duration);
+        }
+    }
+    d_->item_indexes_valid = true;
+}
+
+void TimelineModel::indexItemBounds(ItemID item_id)
+{
+    if (!d_->item_indexes_valid) {
+        return;
+    }
+    auto it = d_->items.find(item_id);
+    if (it == d_->items.end()) {
+        return;
+    }
+    const qint64 start = it->second->start();
+    const qint64 end = start + it->second->duration();
+    d_->gap_indexes[itemRow(item_id)].insert(item_id, start, end);
+    d_->snap_index.insertItem(item_id, start, end);
+}
+
+void TimelineModel::unindexItemBounds(ItemID item_id)
+{
+    if (!d_->item_indexes_valid) {
+        return;
+    }
+    if (auto it = d_->gap_indexes.find(itemRow(item_id)); it != d_->gap_indexes.end()) {
+        it->second.remove(item_id);
+    }
+    d_->snap_index.removeItem(item_id);
+}
+
+void TimelineModel::beginItemBatch()
+{
+    ++d_->batch_depth;
+}
+
+void TimelineModel::endItemBatch()
+{
+    if (--d_->batch_depth > 0) {
+        return;
+    }
+    auto created = std::exchange(d_->batch_created, {});
+    auto removed = std::exchange(d_->batch_removed, {});
+    auto changed_roles = std::exchange(d_->batch_changed_roles, {});
+    // 新建和删除的条目不再单独通知属性变化
+    for (ItemID item_id : created) {
+        changed_roles.erase(item_id);
+    }
+    for (ItemID item_id : removed) {
+        changed_roles.erase(item_id);
+    }
+
+    if (!removed.isEmpty()) {
+        emit itemsRemoved(removed);
+    }
+    if (!created.isEmpty()) {
+        emit itemsCreated(created);
+    }
+    std::map<int, QList<ItemID>> changed;
+    for (const auto& [item_id, role] : changed_roles) {
+        changed[role].append(item_id);
+    }
+    for (const auto& [role, item_ids] : changed) {
+        emit itemsChanged(item_ids, role);
+    }
+}
+
+void TimelineModel::renumberRow(int row, qint64 from_start)
+{
+    auto row_it = d_->item_table.find(row);
+    if (row_it == d_->item_table.end()) {
+        return;
+    }
+    auto it = row_it->second.lower_bound(from_start);
+    int number = static_cast<int>(std::distance(row_it->second.begin(), it)) + 1;
+    for (; it != row_it->second.end(); ++it, ++number) {
+        if (auto* item_ptr = item(it->second)) {
+            item_ptr->setNumber(number);
+        }
+    }
+}
+
+void TimelineModel::updateRowEnds(int row, ItemID old_head, ItemID old_tail)
+{
+    if (ItemID head = headItem(row); head != old_head) {
+        requestItemOperate(head, TimelineItem::OperationRole::OpUpdateAsHead);
+        if (exists(old_head)) {
+            requestItemOperate(old_head, TimelineItem::OperationRole::OpUpdateAsHead);
+        }
+    }
+    if (ItemID tail = tailItem(row); tail != old_tail) {
+        requestItemOperate(tail, TimelineItem::OperationRole::OpUpdateAsTail);
+        if (exists(old_tail)) {
+            requestItemOperate(old_tail, TimelineItem::OperationRole::OpUpdateAsTail);
+        }
+    }
+}
+
+bool TimelineModel::insertItems(std::vector<std::pair<std::unique_ptr<TimelineItem>, bool>> items)
+{
+    // 先校验全部条目，包括新条目之间是否重叠
+    std::map<int, std::vector<TimelineItem*>> row_items;
+    for (const auto& [item, with_connection] : items) {
+        int row = itemRow(item->itemId());
+        if (row < 0 || row >= d_->row_count || exists(item->itemId()) || isFrameRangeOccupied(row, item->start(), item->duration())) {
+            emit errorOccurred(tr("Another frame already exists in the current location!"));
+            return false;
+        }
+        row_items[row].emplace_back(item.get());
+    }
+    for (auto& [row, row_item_ptrs] : row_items) {
+        std::sort(row_item_ptrs.begin(), row_item_ptrs.end(), [](const TimelineItem* lhs, const TimelineItem* rhs) { return lhs->start() < rhs->start(); });
+        for (std::size_t i = 1; i < row_item_ptrs.size(); ++i) {
+            if (row_item_ptrs[i - 1]->start() + row_item_ptrs[i - 1]->duration() >= row_item_ptrs[i]->start()) {
+                emit errorOccurred(tr("Another frame already exists in the current location!"));
+                return false;
+            }
+        }
+    }
+
+    beginItemBatch();
+    std::map<int, std::pair<ItemID, ItemID>> row_ends;
+    for (const auto& [row, row_item_ptrs] : row_items) {
+        row_ends[row] = { headItem(row), tailItem(row) };
+    }
+    QList<ItemID> created;
+    std::vector<ItemID> connected;
+    for (auto& [item, with_connection] : items) {
+        ItemID item_id = item->itemId();
+        int row = itemRow(item_id);
+        emit itemAboutToCreated(item.get());
+        d_->item_table[row][item->start()] = item_id;
+        d_->item_table_helper[row][item_id] = item->start();
+        d_->items[item_id] = std::move(item);
+        indexItemBounds(item_id);
+        created.append(item_id);
+        if (with_connection) {
+            connected.emplace_back(item_id);
+        }
+    }
+    for (const auto& [row, row_item_ptrs] : row_items) {
+        renumberRow(row, row_item_ptrs.front()->start());
+        updateRowEnds(row, row_ends[row].first, row_ends[row].second);
+    }
+    for (ItemID item_id : connected) {
+        if (auto prev_item_id = previousItem(item_id); prev_item_id != kInvalidItemID && nextConnection(prev_item_id).to != item_id) {
+            removeFrameNextConn(prev_item_id);
+            createFrameConnection(prev_item_id, item_id);
+        }
+        if (auto next_item_id = nextItem(item_id); next_item_id != kInvalidItemID && previousConnection(next_item_id).from != item_id) {
+            removeFramePrevConn(next_item_id);
+            createFrameConnection(item_id, next_item_id);
+        }
+    }
+    d_->dirty = true;
+    d_->batch_created.append(created);
+    endItemBatch();
+
+    for (ItemID item_id : created) {
+        emit requestRebuildItemCache(item_id);
+    }
+    return true;
+}
+
+bool TimelineModel::restoreItems(std::span<const TimelineItemRecord> records)
+{
+    std::vector<std::pair<std::unique_ptr<TimelineItem>, bool>> items;
+    items.reserve(records.size());
+    try {
+        for (const auto& record : records) {
+            auto item = itemFactory()->createItem(record.item_id, this);
+            if (!item || !item->load(nlohmann::json::from_msgpack(record.data))) {
+                TL_LOG_ERROR("Failed to restore item[{}]", record.item_id);
+                return false;
+            }
+            items.emplace_back(std::move(item), record.with_connection);
+        }
+    } catch (const std::exception& excep) {
+        TL_LOG_ERROR("Failed to restore items. Exception: {}", excep.what());
+        return false;
+    }
+    return insertItems(std::move(items));
+}
+
 void from_json(const nlohmann::json& j, TimelineModel& model)
 {
-    j["id_index"].get_to(model.d_->id_index);
-    j["row_count"].get_to(model.d_->row_count);
-    j["hidden_rows"].get_to(model.d_->hidden_types);
-    j["locked_rows"].get_to(model.d_->locked_types);
+    model.loadHeader(j);
+    std::vector<const nlohmann::json*> item_js;
+    for (const auto& item_j : j["items"]) {
+        item_js.emplace_back(&item_j);
+    }
+    model.registerLoadedItems(item_js);
+    for (const auto& conn_item_j : j["prev_conns"]) {
+        model.registerLoadedConn(conn_item_j, false);
+    }
+    for (const auto& conn_item_j : j["next_conns"]) {
+        model.registerLoadedConn(conn_item_j, true);
+    }
+    model.finishLoading();
+}
+
+nlohmann::json TimelineModel::saveHeader() const
+{
+    nlohmann::json j;
+    j["id_index"] = d_->id_index;
+    j["row_count"] = d_->row_count;
+    j["hidden_rows"] = d_->hidden_rows;
+    j["hidden_types"] = d_->hidden_types;
+    j["locked_rows"] = d_->locked_types;
+    j["disabled_rows"] = d_->disabled_types;
+    j["frame_range"] = d_->frame_range;
+    j["view_frame_range"] = d_->view_frame_range;
+    return j;
+}
+
+nlohmann::json TimelineModel::itemData(ItemID item_id) const
+{
+    // 未构造的条目直接解码映射中的数据，保存时不必构造全部条目
+    if (auto stored = findStoredItem(*d_, item_id)) {
+        return storedItemJson(*d_, *stored, item_id);
+    }
+    auto* item_ptr = item(item_id);
+    return item_ptr ? item_ptr->save() : nlohmann::json();
+}
+
+void TimelineModel::loadHeader(const nlohmann::json& j)
+{
+    j["id_index"].get_to(d_->id_index);
+    j["row_count"].get_to(d_->row_count);
+    j["hidden_rows"].get_to(d_->hidden_rows);
+    if (j.contains("hidden_types")) {
+        j["hidden_types"].get_to(d_->hidden_types);
+    }
+    d_->row_slots_valid = false;
+    j["locked_rows"].get_to(d_->locked_types);
     if (j.contains("disabled_rows")) {
-        j["disabled_rows"].get_to(model.d_->disabled_types);
+        j["disabled_rows"].get_to(d_->disabled_types);
+    }
+    j["frame_range"].get_to(d_->frame_range);
+    j["view_frame_range"].get_to(d_->view_frame_range);
+}
+
+void TimelineModel::registerLoadedItems(const std::vector<const nlohmann::json*>& item_js)
+{
+    // 条目的构造和解析互不依赖，先并行写入预分配的槽位，再按原顺序登记，保证结果与串行加载一致
+    std::vector<std::unique_ptr<TimelineItem>> items(item_js.size());
+    std::vector<std::string> errors(item_js.size());
+    TimelineParallel::forEach(
+        item_js.size(),
+        [&](std::size_t i) {
+            try {
+                const auto& item_j = *item_js[i];
+                ItemID item_id = item_j["id"];
+                auto item = itemFactory()->createItem(item_id, this);
+                if (!item) {
+                    errors[i] = std::format("create item[{}] failed!", item_id);
+                } else if (!item->load(item_j["data"])) {
+                    errors[i] = std::format("load item[{}] failed!", item_id);
+                } else {
+                    items[i] = std::move(item);
+                }
+            } catch (const std::exception& excep) {
+                errors[i] = excep.what();
+            }
+        },
+        item_js.size() < kParallelLoadThreshold ? 1 : 0);
+
+    // 按顺序报告第一个错误，与线程调度无关
+    for (const auto& error : errors) {
+        if (!error.empty()) {
+            throw std::exception(error.c_str());
+        }
+    }
+
+    for (auto& item : items) {
+        ItemID item_id = item->itemId();
+        int row = itemRow(item_id);
+        d_->item_table[row][item->start()] = item_id;
+        d_->item_table_helper[row][item_id] = item->start();
+        d_->items[item_id] = std::move(item);
+    }
+}
+
+void TimelineModel::registerLoadedConn(const nlohmann::json& conn_item_j, bool is_next)
+{
+    ItemID item_id = conn_item_j["item_id"];
+    ItemConnID conn_id = conn_item_j["connection"];
+    if (is_next) {
+        d_->next_conns[item_id] = conn_id;
+    } else {
+        d_->prev_conns[item_id] = conn_id;
     }
-    j["frame_range"].get_to(model.d_->frame_range);
-    j["view_frame_range"].get_to(model.d_->view_frame_range);
+}
 
-    nlohmann::json items_j = j["items"];
-    for (const auto& item_j : items_j) {
-        ItemID item_id = item_j["id"];
-        auto item = model.itemFactory()->createItem(item_id, &model);
-        if (!item) {
-            throw std::exception(std::format("create item[{}] failed!", item_id).c_str());
+void TimelineModel::finishLoading()
+{
+    // 通知Frame Range改变
+    emit frameMaximumChanged(d_->frame_range[1]);
+    emit frameMinimumChanged(d_->frame_range[0]);
+    emit viewFrameMaximumChanged(d_->view_frame_range[1]);
+    emit viewFrameMinimumChanged(d_->view_frame_range[0]);
+    emit fpsChanged(d_->fps);
+
+    // 条目、连接、头尾状态和缓存由接收方在重置后按需重建，不再逐条目通知
+    emit modelReset();
+}
+
+// 基于nlohmann SAX接口的流式加载器。
+// items/prev_conns/next_conns数组中的每个元素单独构造为一个小的json对象，处理完即释放；其余顶层字段体积很小，直接收集。
+class TimelineModelSaxLoader {
+public:
+    using json = nlohmann::json;
+
+    explicit TimelineModelSaxLoader(TimelineModel& model)
+        : model_(model)
+    {
+    }
+
+    template <typename Parse>
+    static bool load(TimelineModel& model, Parse&& parse)
+    {
+        model.d_->in_loading = true;
+        auto guard = qScopeGuard([&model] { model.d_->in_loading = false; });
+        emit model.modelAboutToBeReset();
+        model.resetData();
+
+        TimelineModelSaxLoader loader(model);
+        try {
+            if (parse(loader) && loader.finished_) {
+                model.loadHeader(loader.header_);
+                model.finishLoading();
+                return true;
+            }
+        } catch (const std::exception& excep) {
+            loader.error_ = excep.what();
         }
-        if (!item->load(item_j["data"])) {
-            throw std::exception(std::format("load item[{}] failed!", item_id).c_str());
+        TL_LOG_ERROR("Failed to load project. Error: {}", loader.error_.empty() ? "unexpected end of input" : loader.error_);
+        model.resetData();
+        emit model.modelReset();
+        return false;
+    }
+
+    bool null()
+    {
+        return value(nullptr);
+    }
+
+    bool boolean(bool val)
+    {
+        return value(val);
+    }
+
+    bool number_integer(json::number_integer_t val)
+    {
+        return value(val);
+    }
+
+    bool number_unsigned(json::number_unsigned_t val)
+    {
+        return value(val);
+    }
+
+    bool number_float(json::number_float_t val, const json::string_t&)
+    {
+        return value(val);
+    }
+
+    bool string(json::string_t& val)
+    {
+        return value(std::move(val));
+    }
+
+    bool binary(json::binary_t& val)
+    {
+        return value(json::binary(std::move(val)));
+    }
+
+    bool key(json::string_t& val)
+    {
+        if (!stack_.empty()) {
+            key_ = std::move(val);
+        } else if (depth_ == 1) {
+            header_key_ = std::move(val);
+            section_ = sectionOf(header_key_);
         }
-        int row = TimelineModel::itemRow(item_id);
-        model.d_->item_table[row][item->start()] = item_id;
-        model.d_->item_table_helper[row][item_id] = item->start();
-        model.d_->items[item_id] = std::move(item);
-        emit model.itemCreated(item_id);
+        return true;
     }
 
-    nlohmann::json prev_conns_j = j["prev_conns"];
-    for (const auto& conn_item_j : prev_conns_j) {
-        ItemID item_id = conn_item_j["item_id"];
-        ItemConnID conn_id = conn_item_j["connection"];
-        model.d_->prev_conns[item_id] = conn_id;
+    bool start_object(std::size_t)
+    {
+        if (stack_.empty() && depth_ == 0) {
+            depth_ = 1;
+            return true;
+        }
+        return beginContainer(json::object());
     }
 
-    nlohmann::json next_conns_j = j["next_conns"];
-    for (const auto& conn_item_j : next_conns_j) {
-        ItemID item_id = conn_item_j["item_id"];
-        ItemConnID conn_id = conn_item_j["connection"];
-        model.d_->next_conns[item_id] = conn_id;
-        emit model.itemConnCreated(conn_id);
+    bool end_object()
+    {
+        if (stack_.empty()) {
+            if (depth_ != 1) {
+                return fail("unexpected end of object");
+            }
+            depth_ = 0;
+            finished_ = true;
+            return true;
+        }
+        return endContainer();
     }
 
-    // 刷新每一行的头尾节点
-    for (const auto& [_, items] : model.d_->item_table) {
-        size_t item_size = items.size();
-        if (item_size == 0) {
-            continue;
+    bool start_array(std::size_t)
+    {
+        if (stack_.empty() && depth_ == 1 && section_ != Section::Header) {
+            depth_ = 2;
+            return true;
         }
-        emit model.notifyItemOperateFinished(items.begin()->second, TimelineItem::OpUpdateAsHead);
-        if (auto tail_it = std::prev(items.end()); tail_it != items.begin()) {
-            emit model.notifyItemOperateFinished(tail_it->second, TimelineItem::OpUpdateAsTail);
+        return beginContainer(json::array());
+    }
+
+    bool end_array()
+    {
+        if (stack_.empty()) {
+            if (depth_ != 2) {
+                return fail("unexpected end of array");
+            }
+            if (section_ == Section::Items) {
+                flushItems();
+            }
+            depth_ = 1;
+            return true;
         }
+        return endContainer();
     }
 
-    // 通知Frame Range改变
-    emit model.frameMaximumChanged(model.d_->frame_range[1]);
-    emit model.frameMinimumChanged(model.d_->frame_range[0]);
-    emit model.viewFrameMaximumChanged(model.d_->view_frame_range[1]);
-    emit model.viewFrameMinimumChanged(model.d_->view_frame_range[0]);
-    emit model.fpsChanged(model.d_->fps);
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& excep)
+    {
+        return fail(excep.what());
+    }
+
+private:
+    enum class Section {
+        Header = 0,
+        Items,
+        PrevConns,
+        NextConns
+    };
 
-    // 所有数据加载完成之后重建cache
-    for (const auto& [id, _] : model.d_->items) {
-        emit model.requestRebuildItemCache(id);
+    static Section sectionOf(const std::string& key)
+    {
+        if (key == "items") {
+            return Section::Items;
+        }
+        if (key == "prev_conns") {
+            return Section::PrevConns;
+        }
+        if (key == "next_conns") {
+            return Section::NextConns;
+        }
+        return Section::Header;
     }
+
+    bool fail(const std::string& error)
+    {
+        if (error_.empty()) {
+            error_ = error;
+        }
+        return false;
+    }
+
+    template <typename T>
+    bool value(T&& val)
+    {
+        if (stack_.empty()) {
+            if (depth_ != 1) {
+                return fail("unexpected scalar value");
+            }
+            header_[header_key_] = std::forward<T>(val);
+            return true;
+        }
+        auto* top = stack_.back();
+        if (top->is_object()) {
+            (*top)[key_] = std::forward<T>(val);
+        } else {
+            top->emplace_back(std::forward<T>(val));
+        }
+        return true;
+    }
+
+    bool beginContainer(json&& container)
+    {
+        if (stack_.empty()) {
+            if (depth_ == 0) {
+                return fail("project root must be an object");
+            }
+            element_ = std::move(container);
+            stack_.emplace_back(&element_);
+            return true;
+        }
+        auto* top = stack_.back();
+        if (top->is_object()) {
+            stack_.emplace_back(&((*top)[key_] = std::move(container)));
+        } else {
+            stack_.emplace_back(&top->emplace_back(std::move(container)));
+        }
+        return true;
+    }
+
+    void flushItems()
+    {
+        std::vector<const json*> item_js;
+        item_js.reserve(pending_items_.size());
+        for (const auto& item_j : pending_items_) {
+            item_js.emplace_back(&item_j);
+        }
+        model_.registerLoadedItems(item_js);
+        pending_items_.clear();
+    }
+
+    bool endContainer()
+    {
+        stack_.pop_back();
+        if (!stack_.empty()) {
+            return true;
+        }
+
+        switch (section_) {
+        case Section::Items:
+            pending_items_.emplace_back(std::move(element_));
+            if (pending_items_.size() >= kLoadBatchSize) {
+                flushItems();
+            }
+            break;
+        case Section::PrevConns:
+            model_.registerLoadedConn(element_, false);
+            break;
+        case Section::NextConns:
+            model_.registerLoadedConn(element_, true);
+            break;
+        default:
+            header_[header_key_] = std::move(element_);
+            break;
+        }
+        element_ = nullptr;
+        return true;
+    }
+
+private:
+    TimelineModel& model_;
+    // 根对象深度为1，items等数组内部为2
+    int depth_ { 0 };
+    Section section_ { Section::Header };
+    std::string header_key_;
+    json header_ = json::object();
+    // 当前正在构造的元素及其内部容器栈
+    json element_;
+    std::vector<json*> stack_;
+    std::string key_;
+    // 攒够一批条目后并行解析，内存上限为一批条目
+    std::vector<json> pending_items_;
+    bool finished_ { false };
+    std::string error_;
+};
+
+bool TimelineModel::loadFromData(const QByteArray& data, FileFormat format)
+{
+    if (format == FileFormat::Auto) {
+        format = detectFileFormat(data);
+    }
+    return TimelineModelSaxLoader::load(*this, [&data, format](TimelineModelSaxLoader& loader) {
+        const auto* begin = reinterpret_cast<const std::uint8_t*>(data.constData());
+        const auto* end = begin + data.size();
+        return nlohmann::json::sax_parse(begin, end, &loader, toInputFormat(format));
+    });
+}
+
+bool TimelineModel::loadFrom(QIODevice& device, FileFormat format)
+{
+    if (!device.isReadable()) {
+        TL_LOG_ERROR("Failed to load project. The device is not readable.");
+        return false;
+    }
+    if (format == FileFormat::Auto) {
+        format = detectFileFormat(device.peek(kDetectFormatBytes));
+    }
+    return TimelineModelSaxLoader::load(*this, [&device, format](TimelineModelSaxLoader& loader) {
+        TimelineIODeviceBuf buffer(&device);
+        std::istream stream(&buffer);
+        return nlohmann::json::sax_parse(stream, &loader, toInputFormat(format));
+    });
+}
+
+bool TimelineModel::openColumnar(const QString& file_path)
+{
+    auto store = TimelineColumnarStore::open(file_path);
+    if (!store) {
+        return false;
+    }
+
+    d_->in_loading = true;
+    auto guard = qScopeGuard([this] { d_->in_loading = false; });
+    emit modelAboutToBeReset();
+    resetData();
+    try {
+        loadHeader(store->header());
+        // 列按起始帧有序，直接在尾部插入；条目本身在首次访问时才构造
+        for (const auto& row : store->rows()) {
+            auto& table = d_->item_table[row.row];
+            auto& helper = d_->item_table_helper[row.row];
+            helper.reserve(row.count);
+            for (std::size_t i = 0; i < row.count; ++i) {
+                table.emplace_hint(table.end(), row.starts[i], row.ids[i]);
+                helper.emplace(row.ids[i], row.starts[i]);
+            }
+        }
+        for (const auto& entry : store->nextConns()) {
+            d_->next_conns.emplace_hint(d_->next_conns.end(), entry.item_id, ItemConnID { entry.from, entry.to });
+        }
+        for (const auto& entry : store->prevConns()) {
+            d_->prev_conns.emplace_hint(d_->prev_conns.end(), entry.item_id, ItemConnID { entry.from, entry.to });
+        }
+        d_->column_store = std::move(store);
+        finishLoading();
+        return true;
+    } catch (const std::exception& excep) {
+        TL_LOG_ERROR("Failed to load columnar project. Exception: {}", excep.what());
+    }
+    resetData();
+    emit modelReset();
+    return false;
+}
+
+bool TimelineModel::saveColumnar(const QString& file_path) const
+{
+    const QString absolute_path = QFileInfo(file_path).absoluteFilePath();
+    QSaveFile file(absolute_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        TL_LOG_ERROR("Failed to save columnar project. Error: {}", file.errorString().toStdString());
+        return false;
+    }
+
+    TimelineColumnarWriter writer(file);
+    bool ok = writer.begin();
+    std::vector<qint64> starts;
+    std::vector<qint64> durations;
+    std::vector<ItemID> ids;
+    for (const auto& [row, start_map] : d_->item_table) {
+        if (!ok) {
+            break;
+        }
+        starts.clear();
+        durations.clear();
+        ids.clear();
+        for (const auto& [start, item_id] : start_map) {
+            auto stored = findStoredItem(*d_, item_id);
+            auto* item_ptr = stored ? nullptr : item(item_id);
+            starts.emplace_back(start);
+            durations.emplace_back(stored ? stored->row->durations[stored->index] : (item_ptr ? item_ptr->duration() : 0));
+            ids.emplace_back(item_id);
+        }
+        ok = writer.writeRow(row, starts, durations, ids, [this, &ids](std::size_t i, std::vector<std::uint8_t>& buffer) {
+            // 未构造的条目原样拷贝映射中的数据，平移过的条目需要改写起始帧
+            if (auto stored = findStoredItem(*d_, ids[i])) {
+                if (d_->stored_starts.contains(ids[i])) {
+                    nlohmann::json::to_msgpack(storedItemJson(*d_, *stored, ids[i]), buffer);
+                    return true;
+                }
+                auto payload = TimelineColumnarStore::payload(*stored->row, stored->index);
+                buffer.insert(buffer.end(), payload.begin(), payload.end());
+                return true;
+            }
+            auto* item_ptr = item(ids[i]);
+            if (!item_ptr) {
+                return false;
+            }
+            nlohmann::json::to_msgpack(item_ptr->save(), buffer);
+            return true;
+        });
+    }
+
+    auto to_entries = [](const std::map<ItemID, ItemConnID>& conns) {
+        std::vector<TimelineColumnar::ConnEntry> entries;
+        entries.reserve(conns.size());
+        for (const auto& [item_id, conn_id] : conns) {
+            entries.emplace_back(TimelineColumnar::ConnEntry { item_id, conn_id.from, conn_id.to });
+        }
+        return entries;
+    };
+    ok = ok && writer.finish(to_entries(d_->next_conns), to_entries(d_->prev_conns), saveHeader());
+    if (!ok) {
+        file.cancelWriting();
+        TL_LOG_ERROR("Failed to save columnar project. Error: {}", file.errorString().toStdString());
+        return false;
+    }
+
+    // 覆盖当前映射的文件时先解除映射（Windows下无法替换映射中的文件），提交后映射新文件。
+    // 尚未构造的条目原样写入了新文件，位置信息不变
+    const bool remap = d_->column_store && d_->column_store->filePath() == absolute_path;
+    if (remap) {
+        d_->column_store.reset();
+    }
+    const bool committed = file.commit();
+    if (remap) {
+        // 新文件中的起始帧已是平移后的位置
+        if (committed) {
+            d_->stored_starts.clear();
+        }
+        d_->column_store = TimelineColumnarStore::open(absolute_path);
+        if (!d_->column_store) {
+            TL_LOG_ERROR("Failed to remap columnar project {}", absolute_path.toStdString());
+        }
+    }
+    if (!committed) {
+        TL_LOG_ERROR("Failed to save columnar project. Error: {}", file.errorString().toStdString());
+        return false;
+    }
+    return true;
 }
 
 void TimelineModel::notifyLanguageChanged()
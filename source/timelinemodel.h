@@ -3,8 +3,18 @@
 #include "timelinedef.h"
 #include "timelinelibexport.h"
 #include "timelineserializable.h"
+#include "timelinesnapindex.h"
+#include <QByteArray>
+#include <QList>
 #include <QObject>
 #include <QVariant>
+#include <map>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <vector>
+
+class QIODevice;
 
 namespace tl {
 
@@ -12,6 +22,7 @@ class TimelineItem;
 class TimelineItemFactory;
 class TimelineItemCreateCommand;
 class TimelineItemDeleteCommand;
+struct TimelineItemRecord;
 struct TimelineModelPrivate;
 
 class TIMELINE_LIB_EXPORT TimelineModel : public QObject, public TimelineSerializable {
@@ -39,6 +50,30 @@ public:
 
     void removeItem(ItemID item_id);
     ItemID createItem(int item_type, int item_row, qint64 start, qint64 duration = 0, bool with_connection = false);
+    // 批量操作：每行只重新编号和连接一次，结束时以itemsCreated/itemsRemoved/itemsChanged统一通知
+    void removeItems(const QList<ItemID>& item_ids);
+    // 所有条目平移相同帧数且不越过未参与平移的相邻条目，返回实际平移的帧数
+    qint64 moveItems(const QList<ItemID>& item_ids, qint64 delta);
+    // 一组条目整体平移时允许的[最小, 最大]帧数，由每个条目外侧未参与平移的相邻条目和模型的帧范围决定
+    std::pair<qint64, qint64> groupMoveRange(const QList<ItemID>& item_ids) const;
+    // 波纹编辑：起始帧不小于from_frame的条目整体平移delta，row为kAllRows时作用于所有行；
+    // delta为负时[from_frame + delta, from_frame)内不能有条目起始，平移后也不能与前面的条目重叠，
+    // 因此总能以rippleShift(row, from_frame + delta, -delta)撤销；
+    // 平移后的条目不能超出[frameMinimum(), frameMaximum()]，任一行冲突时不做修改
+    constexpr static int kAllRows = -1;
+    bool rippleShift(int row, qint64 from_frame, qint64 delta);
+    // 空位查询，基于每行的空位索引，O(log n)
+    // 不早于from、能放下duration的第一个起始帧，行号无效时返回-1
+    qint64 findFirstFreeSlot(int row, qint64 from, qint64 duration) const;
+    // [first, last]内最大的连续空位，返回{起始帧, 帧数}
+    std::pair<qint64, qint64> largestGap(int row, qint64 first, qint64 last) const;
+    // 吸附：所有行的条目边界、播放头和标记中与frame_no相距不超过tolerance帧的最近目标
+    std::optional<TimelineSnapTarget> nearestSnapTarget(qint64 frame_no, qint64 tolerance, const TimelineSnapFilter& filter = {}) const;
+    // 播放头和标记只作为吸附目标，模型重置时保留；frame_no小于0时移除播放头
+    void setSnapPlayhead(qint64 frame_no);
+    void addSnapMarker(qint64 frame_no);
+    void removeSnapMarker(qint64 frame_no);
+    void clearSnapMarkers();
     ItemConnID createFrameConnection(ItemID from, ItemID to);
     ItemConnID previousConnection(ItemID item_id) const;
     ItemConnID nextConnection(ItemID item_id) const;
@@ -54,8 +89,12 @@ public:
 
     TimelineItemFactory* itemFactory() const;
 
+    // 隐藏类型并隐藏该类型所在的行row
     void setTypeHidden(int row, int type, bool hidden);
     bool isTypeHidden(int type) const;
+    // 隐藏整行，之后的行依次上移
+    void setRowHidden(int row, bool hidden);
+    bool isRowHidden(int row) const;
     void setTypeLocked(int type, bool locked);
     bool isTypeLocked(int type) const;
     void setTypeDisabled(int type, bool disabled);
@@ -89,9 +128,13 @@ public:
     void setItemHeight(qreal height);
     qreal itemHeight() const;
     qreal itemY(ItemID item_id) const;
+    // 行的纵坐标，隐藏行之后的行依次上移，查询为O(1)
+    qreal rowY(int row) const;
 
     bool isFrameInRange(qint64 start, qint64 duration = 0) const;
     bool isItemInViewRange(ItemID item_id) const;
+    // 条目的[起始帧, 结束帧]，尚未构造的条目不会因此被构造
+    std::optional<std::pair<qint64, qint64>> itemFrameRange(ItemID item_id) const;
 
     bool modifyItemStart(ItemID item_id, qint64 start, bool clamp_to_range = true);
 
@@ -99,7 +142,40 @@ public:
     ItemID tailItem(int row) const;
     ItemID previousItem(ItemID item_id) const;
     ItemID nextItem(ItemID item_id) const;
+    // 整行拷贝，只读遍历请用rowItemRange()
     std::map<qint64, ItemID> rowItems(int row) const;
+    // 行内与[first, last]帧区间相交的条目，按起始帧升序
+    std::vector<ItemID> rowItemsInRange(int row, qint64 first, qint64 last) const;
+    // 行内条目的只读视图，元素为{起始帧, 条目}，按起始帧升序，不拷贝；
+    // 该行增删或移动条目后失效，遍历过程中需要修改时用rowItemsSnapshot()
+    using RowItemRange = std::ranges::subrange<std::map<qint64, ItemID>::const_iterator>;
+    RowItemRange rowItemRange(int row) const;
+    // 与[first, last]帧区间相交的部分
+    RowItemRange rowItemRange(int row, qint64 first, qint64 last) const;
+    // fn(start, item_id)返回false时停止遍历
+    template <typename Func>
+    void forEachInRow(int row, qint64 first, qint64 last, Func&& fn) const
+    {
+        for (const auto& [start, item_id] : rowItemRange(row, first, last)) {
+            if constexpr (std::is_same_v<std::invoke_result_t<Func&, qint64, ItemID>, bool>) {
+                if (!fn(start, item_id)) {
+                    return;
+                }
+            } else {
+                fn(start, item_id);
+            }
+        }
+    }
+    // 与[first, last]相交部分的快照，只分配一次，遍历时可以修改模型
+    std::vector<std::pair<qint64, ItemID>> rowItemsSnapshot(int row, qint64 first, qint64 last) const;
+    // 行内覆盖frame_no的条目，没有时返回kInvalidItemID；
+    // next_change返回结果可能改变的下一帧，即该条目结束后一帧或下一个条目的起始帧
+    ItemID itemAtFrame(int row, qint64 frame_no, qint64* next_change = nullptr) const;
+    // 竖切查询：各行在frame_no处的条目，下标为行号
+    std::vector<ItemID> itemsAtFrame(qint64 frame_no) const;
+    // 多个帧的竖切结果依次排列，第i帧第row行为result[i * rowCount() + row]；
+    // 帧号递增时每行只在跨过条目边界时重新查找，播放头连续移动请用TimelineFrameCursor
+    std::vector<ItemID> itemsAtFrames(std::span<const qint64> frames) const;
 
     void notifyItemPropertyChanged(ItemID item_id, int role, const QVariant& old_val = QVariant());
     void notifyItemOperateFinished(ItemID item_id, int op_role, const QVariant& param = QVariant());
@@ -107,10 +183,27 @@ public:
     bool load(const nlohmann::json& j) override;
     nlohmann::json save() const override;
 
+    // JSON用于数据交换，CBOR/MessagePack体积更小
+    bool loadFromData(const QByteArray& data, FileFormat format = FileFormat::Auto);
+    // 流式加载，边解析边构造条目，内存峰值与单个条目大小相当
+    bool loadFrom(QIODevice& device, FileFormat format = FileFormat::Auto);
+    QByteArray saveToData(FileFormat format = FileFormat::Json) const;
+    // 流式写出，按item_table顺序逐个序列化条目，内存占用与工程大小无关
+    bool saveTo(QIODevice& device, FileFormat format = FileFormat::Json) const;
+    static FileFormat detectFileFormat(const QByteArray& data);
+
+    // 列式工程文件：打开时映射文件并只建立行索引，条目在首次通过item()访问时才构造，
+    // 常驻内存取决于实际查看和编辑的条目数量
+    bool openColumnar(const QString& file_path);
+    bool saveColumnar(const QString& file_path) const;
+
     qint64 frameToTime(qint64 frame_no) const;
 
     QString copyItem(ItemID item_id) const;
     ItemID pasteItem(const QString& data, qint64 frame_no);
+    // 保持条目间的相对位置，最早的条目放到frame_no；任一条目位置冲突时不粘贴
+    QString copyItems(const QList<ItemID>& item_ids) const;
+    QList<ItemID> pasteItems(const QString& data, qint64 frame_no);
 
     bool isInLoading() const;
 
@@ -123,6 +216,12 @@ signals:
     void itemChangedByTransaction(ItemID item_id, int op_role, const QVariant& old_val = QVariant());
     void itemOperateFinished(ItemID item_id, int op_role, const QVariant& param = QVariant());
 
+    // 批量操作的合并通知，期间不逐条目发出itemCreated/itemRemoved/itemChanged
+    void itemsCreated(const QList<ItemID>& item_ids);
+    void itemsAboutToBeRemoved(const QList<ItemID>& item_ids);
+    void itemsRemoved(const QList<ItemID>& item_ids);
+    void itemsChanged(const QList<ItemID>& item_ids, int role);
+
     void itemConnCreated(const ItemConnID& conn_id);
     void itemConnRemoved(const ItemConnID& conn_id);
 
@@ -130,7 +229,11 @@ signals:
     void requestRebuildItemCache(ItemID item_id);
 
     void rowCountChanged(int row_count);
+    // 该类型的条目整体禁用或重新启用，isItemDisabled()的结果随之变化
+    void typeDisabledChanged(int type, bool disabled);
     void requestUpdateItemY(ItemID item_id);
+    // first_row及之后各行的纵坐标或隐藏状态变化，接收方按行重新布局
+    void rowLayoutChanged(int first_row);
 
     void frameMaximumChanged(qint64 maximum);
     void frameMinimumChanged(qint64 minimum);
@@ -140,16 +243,55 @@ signals:
 
     void errorOccurred(const QString& error);
 
+    // 加载工程或clear()时整体替换数据，期间不逐条目发出itemCreated/itemRemoved等信号，接收方应在modelReset后重新读取模型
+    void modelAboutToBeReset();
+    void modelReset();
+
 protected:
     friend void from_json(const nlohmann::json& j, TimelineModel& item);
+    friend class TimelineModelSaxLoader;
 
 private:
     ItemID nextItemID() const;
+    TimelineItem* materializeItem(ItemID item_id) const;
+    // 条目的序列化数据，尚未构造的条目不会因此被构造
+    nlohmann::json itemData(ItemID item_id) const;
+
+    // 加载流程：先登记条目与连接，全部完成后统一发出通知
+    void loadHeader(const nlohmann::json& j);
+    nlohmann::json saveHeader() const;
+    // 条目数据并行解析，按传入顺序登记
+    void registerLoadedItems(const std::vector<const nlohmann::json*>& item_js);
+    void registerLoadedConn(const nlohmann::json& conn_item_j, bool is_next);
+    void finishLoading();
+    // 丢弃所有条目、连接和行状态，不发出信号
+    void resetData();
+
+    // 批量操作期间条目属性变化先合并，endItemBatch()时统一发出
+    void beginItemBatch();
+    void endItemBatch();
+    // 从from_start开始按帧顺序重新设置序号
+    void renumberRow(int row, qint64 from_start);
+    // 行首尾条目变化后通知新旧首尾条目更新
+    void updateRowEnds(int row, ItemID old_head, ItemID old_tail);
+    // 一次性登记多个条目，先校验全部位置，冲突时不做任何修改
+    bool insertItems(std::vector<std::pair<std::unique_ptr<TimelineItem>, bool>> items);
+    bool restoreItems(std::span<const TimelineItemRecord> records);
+
+    // 条目的结束帧，尚未构造的条目不会因此被构造
+    qint64 itemEnd(ItemID item_id, qint64 start) const;
+    void ensureItemIndexes() const;
+    void indexItemBounds(ItemID item_id);
+    void unindexItemBounds(ItemID item_id);
 
     friend class TimelineItemCreateCommand;
     friend class TimelineItemDeleteCommand;
+    friend struct TimelineItemRecord;
+    friend class TimelineAutosave;
     virtual void loadItem(const nlohmann::json& j, const std::optional<ItemID>& item_id_opt = std::nullopt, const std::optional<qint64>& start = std::nullopt);
     virtual nlohmann::json saveItem(ItemID item_id) const;
+    // loadItem()的实现，撤销记录直接传入解码后的条目数据
+    void loadItemData(ItemID item_id, const nlohmann::json& data, bool with_connection, const std::optional<qint64>& start = std::nullopt);
 
 private:
     TimelineModelPrivate* d_ { nullptr };
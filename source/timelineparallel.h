@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tl {
+
+class TimelineParallel {
+public:
+    // 工作线程数，0表示使用硬件并发数
+    static unsigned threadCount(unsigned max_threads = 0)
+    {
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        return max_threads == 0 ? hw : std::min(hw, max_threads);
+    }
+
+    // 对[0, count)中的每个下标调用func(index)，任务按原子计数动态分配给各线程，调用线程也参与计算。
+    // func抛出的第一个异常会在所有线程结束后重新抛出。
+    template <typename Func>
+    static void forEach(std::size_t count, Func&& func, unsigned max_threads = 0)
+    {
+        if (count == 0) {
+            return;
+        }
+        const unsigned thread_count = static_cast<unsigned>(std::min<std::size_t>(threadCount(max_threads), count));
+        if (thread_count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                func(i);
+            }
+            return;
+        }
+
+        std::atomic<std::size_t> next_index { 0 };
+        std::atomic<bool> failed { false };
+        std::exception_ptr first_error;
+        std::mutex error_mutex;
+
+        auto worker = [&] {
+            for (;;) {
+                std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+                if (index >= count || failed.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                try {
+                    func(index);
+                } catch (...) {
+                    std::lock_guard lock(error_mutex);
+                    if (!first_error) {
+                        first_error = std::current_exception();
+                    }
+                    failed.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(thread_count - 1);
+            for (unsigned i = 1; i < thread_count; ++i) {
+                threads.emplace_back(worker);
+            }
+            worker();
+        }
+
+        if (first_error) {
+            std::rethrow_exception(first_error);
+        }
+    }
+};
+
+} // namespace tl
\ No newline at end of file
@@ -2,21 +2,63 @@
 #include "item/timelineitem.h"
 #include "itemview/timelineitemconnview.h"
 #include "itemview/timelineitemview.h"
+#include "itemview/timelinerowview.h"
 #include "timelineaxis.h"
 #include "timelineitemfactory.h"
 #include "timelinemodel.h"
+#include "timelinetransaction.h"
 #include "timelineview.h"
+#include <QElapsedTimer>
 #include <QGraphicsSceneContextMenuEvent>
 #include <QUndoStack>
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
 
 namespace tl {
 
+namespace {
+// 每个事件循环周期内重建媒体缓存的时间预算
+constexpr qint64 kCacheRebuildBudgetMs = 8;
+// 撤销历史默认的内存预算
+constexpr std::size_t kDefaultUndoMemoryBudget = 64 * 1024 * 1024;
+// 默认吸附距离，单位像素
+constexpr qreal kDefaultSnapTolerance = 8.0;
+
+std::size_t undoCommandSize(const QUndoCommand* command)
+{
+    auto* undo_command = dynamic_cast<const TimelineUndoCommand*>(command);
+    if (!undo_command) {
+        return sizeof(QUndoCommand);
+    }
+    return undo_command->isReleased() ? 0 : undo_command->byteSize();
+}
+} // namespace
+
 struct TimelineScenePrivate {
     TimelineView* view { nullptr };
     TimelineModel* model { nullptr };
     QUndoStack* undo_stack { nullptr };
+    // 按行号存放的行容器，需要时创建；声明在条目视图之前，保证子项先于容器销毁
+    std::vector<std::unique_ptr<TimelineRowView>> row_views;
     std::unordered_map<ItemID, std::unique_ptr<TimelineItemView>> item_views;
     std::unordered_map<ItemConnID, std::unique_ptr<TimelineItemConnView>, ItemConnIDHash, ItemConnIDEqual> item_conn_views;
+
+    // 模型重置后只构造视图范围内的条目视图，其余在进入视图范围时再构造
+    bool deferred_item_views { false };
+    std::deque<ItemID> cache_rebuild_queue;
+    std::unordered_set<ItemID> queued_cache_rebuilds;
+    bool cache_rebuild_scheduled { false };
+
+    std::size_t undo_memory_budget { kDefaultUndoMemoryBudget };
+    // 撤销栈底部已释放的命令数，不能再撤销到这些命令之前
+    int released_undo_count { 0 };
+    // 栈中未释放命令的内存总量，压栈、撤销和重做时增量更新
+    std::size_t undo_bytes { 0 };
+
+    bool drag_preview { true };
+    bool snap_enabled { true };
+    qreal snap_tolerance { kDefaultSnapTolerance };
 };
 
 TimelineScene::TimelineScene(TimelineModel* model, QObject* parent)
@@ -25,16 +67,38 @@ TimelineScene::TimelineScene(TimelineModel* model, QObject* parent)
 {
     d_->undo_stack = new QUndoStack(this);
     d_->model = model;
+    connect(model, &TimelineModel::modelAboutToBeReset, this, &TimelineScene::onModelAboutToBeReset);
+    connect(model, &TimelineModel::modelReset, this, &TimelineScene::onModelReset);
     connect(model, &TimelineModel::itemCreated, this, &TimelineScene::onItemCreated);
     connect(model, &TimelineModel::itemChanged, this, &TimelineScene::onItemChanged);
     connect(model, &TimelineModel::itemRemoved, this, &TimelineScene::onItemRemoved);
+    connect(model, &TimelineModel::itemsCreated, this, &TimelineScene::onItemsCreated);
+    connect(model, &TimelineModel::itemsChanged, this, [this](const QList<ItemID>& item_ids, int role) {
+        for (ItemID item_id : item_ids) {
+            onItemChanged(item_id, role);
+        }
+    });
+    connect(model, &TimelineModel::itemsRemoved, this, [this](const QList<ItemID>& item_ids) {
+        for (ItemID item_id : item_ids) {
+            onItemRemoved(item_id);
+        }
+    });
     connect(model, &TimelineModel::itemOperateFinished, this, &TimelineScene::onItemOperateFinished);
     connect(model, &TimelineModel::requestUpdateItemY, this, &TimelineScene::onUpdateItemYRequested);
+    connect(model, &TimelineModel::rowLayoutChanged, this, &TimelineScene::onRowLayoutChanged);
 
     connect(model, &TimelineModel::itemConnCreated, this, &TimelineScene::onItemConnCreated);
     connect(model, &TimelineModel::itemConnRemoved, this, &TimelineScene::onItemConnRemoved);
     connect(model, &TimelineModel::requestRefreshItemViewCache, this, &TimelineScene::onRefreshItemViewCacheRequested);
     connect(model, &TimelineModel::requestRebuildItemCache, this, &TimelineScene::onRebuildItemViewCacheRequested);
+
+    connect(this, &QGraphicsScene::sceneRectChanged, this, [this] {
+        for (const auto& row_view : d_->row_views) {
+            if (row_view) {
+                row_view->updateGeometry();
+            }
+        }
+    });
 }
 
 TimelineScene::~TimelineScene() noexcept
@@ -83,11 +147,21 @@ qreal TimelineScene::itemConnViewWidth(const ItemConnID& conn_id) const
         return 0;
     }
 
-    qint64 from_dest = from_item->destination();
-    qint64 to_start = to_item->start();
+    qint64 from_dest = itemViewStart(conn_id.from) + from_item->duration();
+    qint64 to_start = itemViewStart(conn_id.to);
     return qMax(0.0, mapFrameToAxis(to_start - from_dest) - axisTickWidth());
 }
 
+qint64 TimelineScene::itemViewStart(ItemID item_id) const
+{
+    auto* item_view = itemView(item_id);
+    if (item_view && item_view->previewStart() >= 0) {
+        return item_view->previewStart();
+    }
+    auto* item = model()->item(item_id);
+    return item ? item->start() : -1;
+}
+
 qreal TimelineScene::mapFrameToAxis(qint64 time) const
 {
     if (!d_->view) {
@@ -122,6 +196,8 @@ qreal TimelineScene::axisFrameWidth() const
 
 void TimelineScene::fitInAxis()
 {
+    ensureVisibleItemViews();
+
     for (const auto& [_, item] : d_->item_views) {
         item->fitInAxis();
     }
@@ -156,40 +232,149 @@ void TimelineScene::contextMenuEvent(QGraphicsSceneContextMenuEvent* event)
     emit requestSceneContextMenu();
 }
 
+void TimelineScene::onModelAboutToBeReset()
+{
+    // 只销毁场景自己创建的行容器、条目和连接线视图，宿主添加的图元保留。
+    // 删除期间关闭空间索引，避免逐个从索引中移除，之后再按原方式为剩余图元重建
+    const auto index_method = itemIndexMethod();
+    setItemIndexMethod(QGraphicsScene::NoIndex);
+    d_->item_conn_views.clear();
+    d_->item_views.clear();
+    d_->row_views.clear();
+    setItemIndexMethod(index_method);
+    d_->cache_rebuild_queue.clear();
+    d_->queued_cache_rebuilds.clear();
+}
+
+void TimelineScene::onModelReset()
+{
+    d_->deferred_item_views = true;
+    ensureVisibleItemViews();
+}
+
 void TimelineScene::onItemCreated(ItemID item_id)
+{
+    createItemView(item_id);
+}
+
+TimelineItemView* TimelineScene::createItemView(ItemID item_id)
 {
     auto item_view = model()->itemFactory()->createItemView(item_id, this);
+    if (!item_view) {
+        return nullptr;
+    }
     connect(item_view.get(), &TimelineItemView::requestMoveItem, this, &TimelineScene::requestMoveItem);
+    connect(item_view.get(), &TimelineItemView::requestMoveItems, this, &TimelineScene::requestMoveItems);
     connect(item_view.get(), &TimelineItemView::moveFinished, this, &TimelineScene::itemMoveFinished);
+    if (auto* row_view = rowView(TimelineModel::itemRow(item_id))) {
+        item_view->setParentItem(row_view);
+        item_view->updateY();
+    }
+    auto* result = item_view.get();
     d_->item_views[item_id] = std::move(item_view);
+    return result;
+}
+
+TimelineItemConnView* TimelineScene::createItemConnView(const ItemConnID& conn_id)
+{
+    auto* item_view = itemView(conn_id.from);
+    if (!item_view) {
+        return nullptr;
+    }
+    auto conn_item = new TimelineItemConnView(conn_id, *this);
+    // 连接线与起点条目在同一个行容器中
+    conn_item->setParentItem(item_view->parentItem());
+    conn_item->updateY();
+    connect(item_view, &QGraphicsObject::yChanged, conn_item, [conn_item, item_view] { conn_item->setY(item_view->y()); });
+    d_->item_conn_views[conn_id].reset(conn_item);
+    return conn_item;
+}
+
+void TimelineScene::ensureVisibleItemViews()
+{
+    if (!d_->deferred_item_views) {
+        return;
+    }
+    auto* model = this->model();
+    for (int row = 0; row < model->rowCount(); ++row) {
+        for (ItemID item_id : model->rowItemsInRange(row, model->viewFrameMinimum(), model->viewFrameMaximum())) {
+            ensureItemView(item_id);
+        }
+    }
+}
+
+void TimelineScene::ensureItemView(ItemID item_id)
+{
+    if (!itemView(item_id)) {
+        if (!createItemView(item_id)) {
+            return;
+        }
+        scheduleCacheRebuild(item_id);
+    }
+
+    // 连接线挂在起点条目的视图上，起点在视图范围外时也要构造起点视图
+    auto prev_conn_id = model()->previousConnection(item_id);
+    if (prev_conn_id.isValid() && !itemView(prev_conn_id.from) && createItemView(prev_conn_id.from)) {
+        scheduleCacheRebuild(prev_conn_id.from);
+    }
+    for (const auto& conn_id : { prev_conn_id, model()->nextConnection(item_id) }) {
+        if (conn_id.isValid() && !itemConnView(conn_id)) {
+            createItemConnView(conn_id);
+        }
+    }
 }
 
 void TimelineScene::onItemChanged(ItemID item_id, int role)
 {
     auto* item_view = itemView(item_id);
     if (!item_view) {
+        // 尚未构造视图的条目移动到视图范围内时补建视图，不在范围内的条目不构造
+        if (!d_->deferred_item_views || !(role & (TimelineItem::StartRole | TimelineItem::DurationRole))) {
+            return;
+        }
+        auto range = model()->itemFrameRange(item_id);
+        if (range && range->first <= model()->viewFrameMaximum() && range->second >= model()->viewFrameMinimum()) {
+            ensureItemView(item_id);
+        }
         return;
     }
     item_view->onItemChanged(role);
 
     // 尝试更新item之间的连接线
-    if (role & TimelineItem::StartRole) {
-        auto prev_conn_id = model()->previousConnection(item_id);
-        if (prev_conn_id.isValid()) {
-            auto* prev_conn_view = itemConnView(prev_conn_id);
-            if (prev_conn_view) {
-                prev_conn_view->updateX();
-            }
+    if (role & (TimelineItem::DurationRole | TimelineItem::StartRole)) {
+        updateItemConnViews(item_id);
+    }
+}
+
+void TimelineScene::updateItemConnViews(ItemID item_id)
+{
+    auto prev_conn_id = model()->previousConnection(item_id);
+    if (prev_conn_id.isValid()) {
+        auto* prev_conn_view = itemConnView(prev_conn_id);
+        if (prev_conn_view) {
+            prev_conn_view->updateX();
         }
     }
-    if (role & (TimelineItem::DurationRole | TimelineItem::StartRole)) {
-        auto next_conn_id = model()->nextConnection(item_id);
-        if (next_conn_id.isValid()) {
-            auto* next_conn_view = itemConnView(next_conn_id);
-            if (next_conn_view) {
-                next_conn_view->updateX();
-            }
+    auto next_conn_id = model()->nextConnection(item_id);
+    if (next_conn_id.isValid()) {
+        auto* next_conn_view = itemConnView(next_conn_id);
+        if (next_conn_view) {
+            next_conn_view->updateX();
+        }
+    }
+}
+
+void TimelineScene::onItemsCreated(const QList<ItemID>& item_ids)
+{
+    // 批量创建时连接先于条目通知发出，连接线视图在这里补建
+    auto* model = this->model();
+    for (ItemID item_id : item_ids) {
+        auto* item = model->item(item_id);
+        if (d_->deferred_item_views
+            && (!item || item->start() > model->viewFrameMaximum() || item->start() + item->duration() < model->viewFrameMinimum())) {
+            continue;
         }
+        ensureItemView(item_id);
     }
 }
 
@@ -211,16 +396,34 @@ void TimelineScene::onUpdateItemYRequested(ItemID item_id)
     item_view->updateY();
 }
 
-void TimelineScene::onItemConnCreated(const ItemConnID& conn_id)
+void TimelineScene::onRowLayoutChanged(int first_row)
 {
+    // 只移动行容器，与行内的条目数无关
+    for (std::size_t row = std::max(first_row, 0); row < d_->row_views.size(); ++row) {
+        if (d_->row_views[row]) {
+            d_->row_views[row]->updateLayout();
+        }
+    }
+}
 
-    auto* item_view = itemView(conn_id.from);
-    if (!item_view) {
-        return;
+TimelineRowView* TimelineScene::rowView(int row)
+{
+    if (row < 0 || row >= model()->rowCount()) {
+        return nullptr;
     }
-    auto conn_item = new TimelineItemConnView(conn_id, *this);
-    connect(item_view, &QGraphicsObject::yChanged, conn_item, [conn_item, item_view] { conn_item->setY(item_view->y()); });
-    d_->item_conn_views[conn_id].reset(conn_item);
+    if (static_cast<std::size_t>(row) >= d_->row_views.size()) {
+        d_->row_views.resize(row + 1);
+    }
+    auto& row_view = d_->row_views[row];
+    if (!row_view) {
+        row_view = std::make_unique<TimelineRowView>(row, *this);
+    }
+    return row_view.get();
+}
+
+void TimelineScene::onItemConnCreated(const ItemConnID& conn_id)
+{
+    createItemConnView(conn_id);
 }
 
 void TimelineScene::onItemConnRemoved(const ItemConnID& conn_id)
@@ -245,6 +448,58 @@ TimelineView* TimelineScene::view() const
     return d_->view;
 }
 
+void TimelineScene::setDragPreviewEnabled(bool enabled)
+{
+    d_->drag_preview = enabled;
+}
+
+bool TimelineScene::isDragPreviewEnabled() const
+{
+    return d_->drag_preview;
+}
+
+void TimelineScene::setSnapEnabled(bool enabled)
+{
+    d_->snap_enabled = enabled;
+}
+
+bool TimelineScene::isSnapEnabled() const
+{
+    return d_->snap_enabled;
+}
+
+void TimelineScene::setSnapTolerance(qreal pixels)
+{
+    d_->snap_tolerance = qMax(0.0, pixels);
+}
+
+qreal TimelineScene::snapTolerance() const
+{
+    return d_->snap_tolerance;
+}
+
+qint64 TimelineScene::snapItemStart(qint64 start, qint64 duration, const TimelineSnapFilter& filter) const
+{
+    const qreal frame_width = axisFrameWidth();
+    if (!d_->snap_enabled || !d_->model || frame_width <= 0) {
+        return start;
+    }
+    const qint64 tolerance = static_cast<qint64>(d_->snap_tolerance / frame_width);
+    // 起点和终点分别查询，取距离较近的一个
+    auto start_target = d_->model->nearestSnapTarget(start, tolerance, filter);
+    auto end_target = d_->model->nearestSnapTarget(start + duration, tolerance, filter);
+    qint64 snapped = start;
+    qint64 best = tolerance + 1;
+    if (start_target) {
+        snapped = start_target->frame;
+        best = qAbs(start_target->frame - start);
+    }
+    if (end_target && qAbs(end_target->frame - start - duration) < best) {
+        snapped = end_target->frame - duration;
+    }
+    return snapped;
+}
+
 QList<ItemID> TimelineScene::selectedItems() const
 {
     QList<ItemID> ids;
@@ -274,30 +529,99 @@ void TimelineScene::onRefreshItemViewCacheRequested(ItemID item_id)
 
 void TimelineScene::onRebuildItemViewCacheRequested(ItemID item_id)
 {
-    auto* item_view = itemView(item_id);
-    if (!item_view) {
+    if (!itemView(item_id)) {
         return;
     }
-    item_view->rebuildCache();
+    scheduleCacheRebuild(item_id);
+}
+
+void TimelineScene::scheduleCacheRebuild(ItemID item_id)
+{
+    if (!d_->queued_cache_rebuilds.emplace(item_id).second) {
+        return;
+    }
+    d_->cache_rebuild_queue.emplace_back(item_id);
+    if (d_->cache_rebuild_scheduled) {
+        return;
+    }
+    d_->cache_rebuild_scheduled = true;
+    QMetaObject::invokeMethod(this, [this] { processCacheRebuilds(); }, Qt::QueuedConnection);
+}
+
+void TimelineScene::processCacheRebuilds()
+{
+    d_->cache_rebuild_scheduled = false;
+    QElapsedTimer timer;
+    timer.start();
+    while (!d_->cache_rebuild_queue.empty()) {
+        ItemID item_id = d_->cache_rebuild_queue.front();
+        d_->cache_rebuild_queue.pop_front();
+        d_->queued_cache_rebuilds.erase(item_id);
+        if (auto* item_view = itemView(item_id)) {
+            item_view->rebuildCache();
+        }
+        if (timer.elapsed() >= kCacheRebuildBudgetMs) {
+            break;
+        }
+    }
+
+    // 超出时间预算时剩余的条目留到下一个事件循环周期
+    if (!d_->cache_rebuild_queue.empty()) {
+        d_->cache_rebuild_scheduled = true;
+        QMetaObject::invokeMethod(this, [this] { processCacheRebuilds(); }, Qt::QueuedConnection);
+    }
 }
 
 void TimelineScene::recordUndo(QUndoCommand* command)
 {
-    d_->undo_stack->push(command);
+    auto* stack = d_->undo_stack;
+    // 压栈会删除重做部分的命令
+    for (int i = stack->index(); i < stack->count(); ++i) {
+        d_->undo_bytes -= undoCommandSize(stack->command(i));
+    }
+    // 新命令可能合并到栈顶命令中，或使栈顶命令失效而被删除
+    const int top = stack->index() - 1;
+    const std::size_t top_size = top >= 0 ? undoCommandSize(stack->command(top)) : 0;
+    stack->push(command);
+    if (stack->count() > top + 1) {
+        d_->undo_bytes += undoCommandSize(stack->command(stack->count() - 1));
+    } else if (stack->count() == top + 1) {
+        d_->undo_bytes = d_->undo_bytes - top_size + undoCommandSize(stack->command(top));
+    } else {
+        d_->undo_bytes -= top_size;
+    }
+    trimUndoHistory();
 }
 
 void TimelineScene::undo()
 {
-    if (d_->undo_stack->canUndo()) {
-        d_->undo_stack->undo();
+    // 最早的命令已释放时停在此处
+    auto* stack = d_->undo_stack;
+    if (!stack->canUndo() || stack->index() <= d_->released_undo_count) {
+        return;
     }
+    const int index = stack->index() - 1;
+    const std::size_t old_size = undoCommandSize(stack->command(index));
+    stack->undo();
+    // 撤销时命令可能记录更多数据，也可能失效而被删除
+    const bool removed = stack->count() <= index;
+    d_->undo_bytes = d_->undo_bytes - old_size + (removed ? 0 : undoCommandSize(stack->command(index)));
+    trimUndoHistory();
 }
 
 void TimelineScene::redo()
 {
-    if (d_->undo_stack->canRedo()) {
-        d_->undo_stack->redo();
+    auto* stack = d_->undo_stack;
+    if (!stack->canRedo()) {
+        return;
     }
+    const int index = stack->index();
+    const std::size_t old_size = undoCommandSize(stack->command(index));
+    const int old_count = stack->count();
+    stack->redo();
+    const bool removed = stack->count() < old_count;
+    d_->undo_bytes = d_->undo_bytes - old_size + (removed ? 0 : undoCommandSize(stack->command(index)));
+    trimUndoHistory();
 }
 
 QUndoStack* TimelineScene::undoStack() const
@@ -305,4 +629,43 @@ QUndoStack* TimelineScene::undoStack() const
     return d_->undo_stack;
 }
 
+void TimelineScene::setUndoMemoryBudget(std::size_t bytes)
+{
+    d_->undo_memory_budget = bytes;
+    trimUndoHistory();
+}
+
+std::size_t TimelineScene::undoMemoryBudget() const
+{
+    return d_->undo_memory_budget;
+}
+
+void TimelineScene::trimUndoHistory()
+{
+    // QUndoStack只能在栈为空时设置数量上限，这里释放最早命令持有的数据并标记为失效，
+    // 直接通过undoStack()撤销到这些命令时由QUndoStack删除
+    auto* stack = d_->undo_stack;
+    d_->released_undo_count = std::min(d_->released_undo_count, stack->count());
+    while (d_->released_undo_count > 0) {
+        auto* undo_command = dynamic_cast<const TimelineUndoCommand*>(stack->command(d_->released_undo_count - 1));
+        if (!undo_command || undo_command->isReleased()) {
+            break;
+        }
+        --d_->released_undo_count;
+    }
+    if (d_->undo_memory_budget == 0) {
+        return;
+    }
+
+    // 至少保留最近一次可撤销的命令
+    while (d_->undo_bytes > d_->undo_memory_budget && d_->released_undo_count < stack->index() - 1) {
+        auto* command = const_cast<QUndoCommand*>(stack->command(d_->released_undo_count));
+        d_->undo_bytes -= undoCommandSize(command);
+        if (auto* undo_command = dynamic_cast<TimelineUndoCommand*>(command)) {
+            undo_command->release();
+        }
+        ++d_->released_undo_count;
+    }
+}
+
 } // namespace tl
@@ -2,6 +2,7 @@
 
 #include "timelinedef.h"
 #include "timelinelibexport.h"
+#include "timelinesnapindex.h"
 #include <QGraphicsScene>
 
 class QUndoCommand;
@@ -10,6 +11,7 @@ class QUndoStack;
 namespace tl {
 class TimelineItemView;
 class TimelineItemConnView;
+class TimelineRowView;
 class TimelineView;
 class TimelineModel;
 struct TimelineScenePrivate;
@@ -25,7 +27,11 @@ public:
     TimelineView* view() const;
     TimelineItemView* itemView(ItemID item_id) const;
     TimelineItemConnView* itemConnView(const ItemConnID& conn_id) const;
+    // 更新条目前后连接线的位置
+    void updateItemConnViews(ItemID item_id);
     qreal itemConnViewWidth(const ItemConnID& conn_id) const;
+    // 条目视图当前显示的起始帧，拖动预览中为预览位置
+    qint64 itemViewStart(ItemID item_id) const;
 
     qreal mapFrameToAxis(qint64 time) const;
     qreal mapFrameToAxisX(qint64 time) const;
@@ -37,28 +43,50 @@ public:
 
     void fitInAxis();
 
+    // 拖动预览：拖动过程中只移动条目视图，松开时才发出一次requestMoveItem，默认开启
+    void setDragPreviewEnabled(bool enabled);
+    bool isDragPreviewEnabled() const;
+
+    // 拖动吸附：条目起点或终点靠近其它条目边界、播放头或标记时对齐过去，默认开启
+    void setSnapEnabled(bool enabled);
+    bool isSnapEnabled() const;
+    // 吸附距离，单位像素
+    void setSnapTolerance(qreal pixels);
+    qreal snapTolerance() const;
+    // 返回吸附后的起始帧，没有可吸附的目标时原样返回
+    qint64 snapItemStart(qint64 start, qint64 duration, const TimelineSnapFilter& filter) const;
+
     void refreshCache();
 
     void undo();
     void redo();
     void recordUndo(QUndoCommand* command);
     QUndoStack* undoStack() const;
+    // 撤销历史的内存预算，超出时释放最早的命令，0表示不限制
+    void setUndoMemoryBudget(std::size_t bytes);
+    std::size_t undoMemoryBudget() const;
 
 signals:
     void requestSceneContextMenu();
     void requestItemContextMenu(ItemID item_id);
     void requestMoveItem(ItemID item_id, qint64 frame_no);
+    // 拖动多选条目，宿主通常以TimelineItemsMoveCommand执行
+    void requestMoveItems(const QList<ItemID>& item_ids, qint64 delta);
     void itemMoveFinished(ItemID item_id, qint64 old_start);
 
 protected:
     void contextMenuEvent(QGraphicsSceneContextMenuEvent* event) override;
 
 private:
+    void onModelAboutToBeReset();
+    void onModelReset();
     void onItemCreated(ItemID item_id);
+    void onItemsCreated(const QList<ItemID>& item_ids);
     void onItemChanged(ItemID item_id, int role);
     void onItemRemoved(ItemID item_id);
     void onItemAboutToBeRemoved(ItemID item_id);
     void onUpdateItemYRequested(ItemID item_id);
+    void onRowLayoutChanged(int first_row);
 
     void onItemConnCreated(const ItemConnID& conn_id);
     void onItemConnRemoved(const ItemConnID& conn_id);
@@ -68,6 +96,21 @@ private:
 
     void onItemOperateFinished(ItemID item_id, int role, const QVariant& param);
 
+    TimelineItemView* createItemView(ItemID item_id);
+    TimelineItemConnView* createItemConnView(const ItemConnID& conn_id);
+    // 行容器，首次访问时创建
+    TimelineRowView* rowView(int row);
+    // 为视图范围内尚未构造的条目创建视图
+    void ensureVisibleItemViews();
+    void ensureItemView(ItemID item_id);
+
+    // 媒体缓存重建排队到事件循环中分批执行，避免阻塞首帧绘制
+    void scheduleCacheRebuild(ItemID item_id);
+    void processCacheRebuilds();
+
+    // 释放超出内存预算的最早撤销命令
+    void trimUndoHistory();
+
 private:
     TimelineScenePrivate* d_ { nullptr };
 };
@@ -0,0 +1,113 @@
+#include "timelinesnapindex.h"
+#include <limits>
+
+namespace tl {
+
+void TimelineSnapIndex::clearItems()
+{
+    for (const auto& [item_id, bounds] : item_edges_) {
+        edges_.erase({ bounds.first, SnapItemStart, item_id });
+        edges_.erase({ bounds.second, SnapItemEnd, item_id });
+    }
+    item_edges_.clear();
+}
+
+void TimelineSnapIndex::insertItem(ItemID item_id, qint64 start, qint64 end)
+{
+    auto [it, inserted] = item_edges_.try_emplace(item_id, start, end);
+    if (!inserted) {
+        if (it->second == std::pair { start, end }) {
+            return;
+        }
+        edges_.erase({ it->second.first, SnapItemStart, item_id });
+        edges_.erase({ it->second.second, SnapItemEnd, item_id });
+        it->second = { start, end };
+    }
+    edges_.insert({ start, SnapItemStart, item_id });
+    edges_.insert({ end, SnapItemEnd, item_id });
+}
+
+void TimelineSnapIndex::removeItem(ItemID item_id)
+{
+    auto it = item_edges_.find(item_id);
+    if (it == item_edges_.end()) {
+        return;
+    }
+    edges_.erase({ it->second.first, SnapItemStart, item_id });
+    edges_.erase({ it->second.second, SnapItemEnd, item_id });
+    item_edges_.erase(it);
+}
+
+void TimelineSnapIndex::setPlayhead(qint64 frame_no)
+{
+    if (frame_no == playhead_) {
+        return;
+    }
+    if (playhead_ >= 0) {
+        edges_.erase({ playhead_, SnapPlayhead, kInvalidItemID });
+    }
+    playhead_ = frame_no < 0 ? -1 : frame_no;
+    if (playhead_ >= 0) {
+        edges_.insert({ playhead_, SnapPlayhead, kInvalidItemID });
+    }
+}
+
+qint64 TimelineSnapIndex::playhead() const
+{
+    return playhead_;
+}
+
+void TimelineSnapIndex::addMarker(qint64 frame_no)
+{
+    edges_.insert({ frame_no, SnapMarker, kInvalidItemID });
+}
+
+void TimelineSnapIndex::removeMarker(qint64 frame_no)
+{
+    edges_.erase({ frame_no, SnapMarker, kInvalidItemID });
+}
+
+void TimelineSnapIndex::clearMarkers()
+{
+    std::erase_if(edges_, [](const Edge& edge) { return edge.kind == SnapMarker; });
+}
+
+std::optional<TimelineSnapTarget> TimelineSnapIndex::nearest(qint64 frame_no, qint64 tolerance, const TimelineSnapFilter& filter) const
+{
+    if (tolerance < 0) {
+        return std::nullopt;
+    }
+    auto accept = [&filter](const Edge& edge) {
+        return (edge.kind & filter.kinds) && !(edge.item_id != kInvalidItemID && filter.excluded_items.contains(edge.item_id));
+    };
+
+    // 从frame_no向两侧扫描，超出容差或已有更近的目标时停止
+    std::optional<TimelineSnapTarget> result;
+    qint64 best = tolerance;
+    const auto pivot = edges_.lower_bound({ frame_no, std::numeric_limits<int>::min(), 0 });
+    for (auto it = pivot; it != edges_.begin();) {
+        --it;
+        const qint64 distance = frame_no - it->frame;
+        if (distance > best) {
+            break;
+        }
+        if (accept(*it)) {
+            result = TimelineSnapTarget { it->frame, static_cast<TimelineSnapKind>(it->kind), it->item_id };
+            best = distance;
+            break;
+        }
+    }
+    for (auto it = pivot; it != edges_.end(); ++it) {
+        const qint64 distance = it->frame - frame_no;
+        if (distance > best || (result && distance == best)) {
+            break;
+        }
+        if (accept(*it)) {
+            result = TimelineSnapTarget { it->frame, static_cast<TimelineSnapKind>(it->kind), it->item_id };
+            break;
+        }
+    }
+    return result;
+}
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "timelinedef.h"
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace tl {
+
+// 吸附目标的种类，可按位组合用于过滤
+enum TimelineSnapKind {
+    SnapItemStart = 0x1,
+    SnapItemEnd = 0x2,
+    SnapPlayhead = 0x4,
+    SnapMarker = 0x8,
+    SnapAll = SnapItemStart | SnapItemEnd | SnapPlayhead | SnapMarker,
+};
+
+struct TimelineSnapTarget {
+    qint64 frame { 0 };
+    TimelineSnapKind kind { SnapItemStart };
+    // 播放头和标记为kInvalidItemID
+    ItemID item_id { kInvalidItemID };
+};
+
+struct TimelineSnapFilter {
+    int kinds { SnapAll };
+    // 通常为正在拖动的条目，不吸附到自身
+    std::unordered_set<ItemID> excluded_items;
+};
+
+// 所有行的条目边界、播放头和标记按帧号排序存放，查询最近的吸附目标为O(log n + k)，
+// k为容差内被过滤掉的边界数
+class TimelineSnapIndex {
+public:
+    // 只清除条目边界，播放头和标记保留
+    void clearItems();
+
+    // 条目已存在时更新其边界
+    void insertItem(ItemID item_id, qint64 start, qint64 end);
+    void removeItem(ItemID item_id);
+
+    // 小于0时移除播放头
+    void setPlayhead(qint64 frame_no);
+    qint64 playhead() const;
+    void addMarker(qint64 frame_no);
+    void removeMarker(qint64 frame_no);
+    void clearMarkers();
+
+    // 与frame_no相距不超过tolerance的最近目标，距离相同时取较早的
+    std::optional<TimelineSnapTarget> nearest(qint64 frame_no, qint64 tolerance, const TimelineSnapFilter& filter = {}) const;
+
+private:
+    struct Edge {
+        qint64 frame;
+        int kind;
+        ItemID item_id;
+
+        auto operator<=>(const Edge&) const = default;
+    };
+
+    std::set<Edge> edges_;
+    std::unordered_map<ItemID, std::pair<qint64, qint64>> item_edges_;
+    qint64 playhead_ { -1 };
+};
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace tl {
+
+// 单生产者单消费者无锁环形队列，只允许一个线程tryPush、另一个线程tryPop
+template <typename T>
+    requires std::is_nothrow_copy_assignable_v<T> && std::is_default_constructible_v<T>
+class TimelineSpscQueue {
+public:
+    explicit TimelineSpscQueue(std::size_t capacity)
+        : capacity_(std::bit_ceil(capacity < 2 ? std::size_t(2) : capacity))
+        , mask_(capacity_ - 1)
+        , slots_(std::make_unique<T[]>(capacity_))
+    {
+    }
+
+    TimelineSpscQueue(const TimelineSpscQueue&) = delete;
+    TimelineSpscQueue& operator=(const TimelineSpscQueue&) = delete;
+
+    bool tryPush(const T& value) noexcept
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == capacity_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == capacity_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value) noexcept
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅供统计使用，并发时结果是近似值
+    std::size_t sizeApprox() const noexcept
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    // 生产者和消费者各自的索引放在独立的cache line上，避免伪共享
+    alignas(kCacheLine) std::atomic<std::size_t> head_ { 0 };
+    std::size_t tail_cache_ { 0 };
+    alignas(kCacheLine) std::atomic<std::size_t> tail_ { 0 };
+    std::size_t head_cache_ { 0 };
+};
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,320 @@
+#include "timelinetrajectorysampler.h"
+#include "item/timelineaimitem.h"
+#include "item/timelinearmitem.h"
+#include "item/timelinefocusitem.h"
+#include "item/timelinetrackitem.h"
+#include "item/timelinezoomitem.h"
+#include "timelinemodel.h"
+#include "timelineparallel.h"
+#include <algorithm>
+
+namespace tl {
+
+namespace {
+int itemChannelCount(const TimelineItem* item)
+{
+    switch (item->type()) {
+    case TimelineArmItem::Type:
+        return static_cast<int>(static_cast<const TimelineArmItem*>(item)->angles().size());
+    case TimelineAimItem::Type:
+        return 4;
+    case TimelineTrackItem::Type:
+    case TimelineFocusItem::Type:
+    case TimelineZoomItem::Type:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// 按通道写入条目数值，dst[c * stride]为第c个通道
+void readItemValues(const TimelineItem* item, double* dst, std::size_t stride)
+{
+    switch (item->type()) {
+    case TimelineArmItem::Type: {
+        const auto& angles = static_cast<const TimelineArmItem*>(item)->angles();
+        for (std::size_t c = 0; c < angles.size(); ++c) {
+            dst[c * stride] = angles[c];
+        }
+    } break;
+    case TimelineAimItem::Type: {
+        auto* aim_item = static_cast<const TimelineAimItem*>(item);
+        dst[0] = aim_item->x();
+        dst[stride] = aim_item->y();
+        dst[2 * stride] = aim_item->z();
+        dst[3 * stride] = aim_item->distance();
+    } break;
+    case TimelineTrackItem::Type:
+        dst[0] = static_cast<const TimelineTrackItem*>(item)->position();
+        break;
+    case TimelineFocusItem::Type:
+        dst[0] = static_cast<const TimelineFocusItem*>(item)->value();
+        break;
+    case TimelineZoomItem::Type:
+        dst[0] = static_cast<const TimelineZoomItem*>(item)->value();
+        break;
+    default:
+        break;
+    }
+}
+} // namespace
+
+// 单行关键帧快照，数值按SoA布局：values[c * size() + k]
+struct TimelineTrajectorySampler::Keyframes {
+    int row { -1 };
+    int item_type { 0 };
+    int channel_count { 0 };
+    std::vector<qint64> starts;
+    std::vector<qint64> ends;
+    // connected[k]表示第k个与第k+1个关键帧之间存在连接
+    std::vector<char> connected;
+    std::vector<double> values;
+
+    inline std::size_t size() const
+    {
+        return starts.size();
+    }
+
+    inline double value(int channel, std::size_t k) const
+    {
+        return values[channel * size() + k];
+    }
+};
+
+TimelineTrajectorySampler::TimelineTrajectorySampler(const TimelineModel* model)
+    : model_(model)
+{
+}
+
+void TimelineTrajectorySampler::setInterpolation(Interpolation interpolation)
+{
+    interpolation_ = interpolation;
+}
+
+TimelineTrajectorySampler::Interpolation TimelineTrajectorySampler::interpolation() const
+{
+    return interpolation_;
+}
+
+void TimelineTrajectorySampler::setMaxThreads(unsigned max_threads)
+{
+    max_threads_ = max_threads;
+}
+
+unsigned TimelineTrajectorySampler::maxThreads() const
+{
+    return max_threads_;
+}
+
+TimelineTrajectorySampler::RowSamples TimelineTrajectorySampler::sampleRow(int row, qint64 first, qint64 last) const
+{
+    RowSamples out;
+    out.row = row;
+    out.first_frame = first;
+    if (row < 0 || row >= model_->rowCount()) {
+        TL_LOG_ERROR("Invalid row[{}], it must between 0 and {}", row, model_->rowCount());
+        return out;
+    }
+    if (last < first) {
+        TL_LOG_ERROR("Invalid sample range [{}, {}]", first, last);
+        return out;
+    }
+    out.frame_count = last - first + 1;
+    evaluate(collectKeyframes(row), out);
+    return out;
+}
+
+std::vector<TimelineTrajectorySampler::RowSamples> TimelineTrajectorySampler::sample(qint64 first, qint64 last) const
+{
+    if (last < first) {
+        TL_LOG_ERROR("Invalid sample range [{}, {}]", first, last);
+        return {};
+    }
+
+    // 关键帧快照在调用线程中读取，工作线程只访问快照，不访问模型
+    const int row_count = model_->rowCount();
+    std::vector<Keyframes> row_keys;
+    row_keys.reserve(row_count);
+    for (int row = 0; row < row_count; ++row) {
+        row_keys.emplace_back(collectKeyframes(row));
+    }
+
+    std::vector<RowSamples> result(row_count);
+    TimelineParallel::forEach(
+        row_count,
+        [&](std::size_t row) {
+            auto& out = result[row];
+            out.row = static_cast<int>(row);
+            out.first_frame = first;
+            out.frame_count = last - first + 1;
+            evaluate(row_keys[row], out);
+        },
+        max_threads_);
+    return result;
+}
+
+TimelineTrajectorySampler::Keyframes TimelineTrajectorySampler::collectKeyframes(int row) const
+{
+    Keyframes keys;
+    keys.row = row;
+
+    std::vector<const TimelineItem*> items;
+    for (const auto& [_, item_id] : model_->rowItemRange(row)) {
+        const auto* item = model_->item(item_id);
+        if (!item || !item->isEnabled() || model_->isItemDisabled(item_id)) {
+            continue;
+        }
+        int channel_count = itemChannelCount(item);
+        if (channel_count == 0) {
+            continue;
+        }
+        // 一行只采样一种类型的条目，以行首条目为准
+        if (keys.item_type == 0) {
+            keys.item_type = item->type();
+        } else if (item->type() != keys.item_type) {
+            TL_LOG_WARN("Item[{}] type {} mismatches row[{}] type {}, skipped.", item_id, item->type(), row, keys.item_type);
+            continue;
+        }
+        keys.channel_count = std::max(keys.channel_count, channel_count);
+        items.emplace_back(item);
+    }
+
+    const std::size_t key_count = items.size();
+    keys.starts.resize(key_count);
+    keys.ends.resize(key_count);
+    keys.connected.resize(key_count, 0);
+    // 关节数不足的条目缺失通道按0补齐
+    keys.values.assign(keys.channel_count * key_count, 0.0);
+    for (std::size_t k = 0; k < key_count; ++k) {
+        keys.starts[k] = items[k]->start();
+        keys.ends[k] = items[k]->end();
+        readItemValues(items[k], keys.values.data() + k, key_count);
+        if (k + 1 < key_count) {
+            keys.connected[k] = model_->nextConnection(items[k]->itemId()).to == items[k + 1]->itemId();
+        }
+    }
+    return keys;
+}
+
+void TimelineTrajectorySampler::evaluate(const Keyframes& keys, RowSamples& out) const
+{
+    out.item_type = keys.item_type;
+    out.channel_count = keys.channel_count;
+    const std::size_t key_count = keys.size();
+    if (key_count == 0 || keys.channel_count == 0 || out.frame_count <= 0) {
+        out.channel_count = 0;
+        out.values.clear();
+        return;
+    }
+
+    const qint64 first = out.first_frame;
+    const qint64 last = out.first_frame + out.frame_count - 1;
+    const qint64 frame_count = out.frame_count;
+    const int channel_count = keys.channel_count;
+    out.values.resize(static_cast<std::size_t>(channel_count) * frame_count);
+    double* const dst = out.values.data();
+
+    // 每段的插值权重按帧计算一次，所有通道共用，内层循环是连续内存上的乘加，便于编译器向量化
+    std::vector<double> w0;
+    std::vector<double> w1;
+    std::vector<double> w2;
+    std::vector<double> w3;
+
+    auto hold = [&](qint64 from, qint64 to, std::size_t k) {
+        from = std::max(from, first);
+        to = std::min(to, last);
+        if (from > to) {
+            return;
+        }
+        for (int c = 0; c < channel_count; ++c) {
+            double* row_dst = dst + c * frame_count + (from - first);
+            std::fill(row_dst, row_dst + (to - from + 1), keys.value(c, k));
+        }
+    };
+
+    // 关键帧k处的切线（每帧变化量），停留段两端速度为0，否则使用Catmull-Rom切线
+    auto tangent = [&](int c, std::size_t k) -> double {
+        if (keys.ends[k] > keys.starts[k] || k == 0 || k + 1 >= key_count || !keys.connected[k - 1] || !keys.connected[k]) {
+            return 0.0;
+        }
+        return (keys.value(c, k + 1) - keys.value(c, k - 1)) / static_cast<double>(keys.starts[k + 1] - keys.ends[k - 1]);
+    };
+
+    auto interpolate = [&](qint64 from, qint64 to, std::size_t k) {
+        const qint64 t0 = keys.ends[k];
+        const double span = static_cast<double>(keys.starts[k + 1] - t0);
+        from = std::max(from, first);
+        to = std::min(to, last);
+        if (from > to) {
+            return;
+        }
+        const std::size_t n = static_cast<std::size_t>(to - from + 1);
+        const std::size_t offset = static_cast<std::size_t>(from - first);
+
+        if (interpolation_ == Interpolation::Linear) {
+            w0.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                w0[i] = static_cast<double>(from - t0 + static_cast<qint64>(i)) / span;
+            }
+            for (int c = 0; c < channel_count; ++c) {
+                const double p0 = keys.value(c, k);
+                const double delta = keys.value(c, k + 1) - p0;
+                double* row_dst = dst + c * frame_count + offset;
+                const double* s = w0.data();
+                for (std::size_t i = 0; i < n; ++i) {
+                    row_dst[i] = p0 + delta * s[i];
+                }
+            }
+            return;
+        }
+
+        // 三次Hermite基函数
+        w0.resize(n);
+        w1.resize(n);
+        w2.resize(n);
+        w3.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const double s = static_cast<double>(from - t0 + static_cast<qint64>(i)) / span;
+            const double s2 = s * s;
+            const double s3 = s2 * s;
+            w0[i] = 2 * s3 - 3 * s2 + 1;
+            w1[i] = s3 - 2 * s2 + s;
+            w2[i] = -2 * s3 + 3 * s2;
+            w3[i] = s3 - s2;
+        }
+        for (int c = 0; c < channel_count; ++c) {
+            const double p0 = keys.value(c, k);
+            const double p1 = keys.value(c, k + 1);
+            const double m0 = tangent(c, k) * span;
+            const double m1 = tangent(c, k + 1) * span;
+            double* row_dst = dst + c * frame_count + offset;
+            const double* h00 = w0.data();
+            const double* h10 = w1.data();
+            const double* h01 = w2.data();
+            const double* h11 = w3.data();
+            for (std::size_t i = 0; i < n; ++i) {
+                row_dst[i] = h00[i] * p0 + h10[i] * m0 + h01[i] * p1 + h11[i] * m1;
+            }
+        }
+    };
+
+    // 从覆盖first的关键帧开始，首个关键帧之前保持首帧数值
+    std::size_t k = std::upper_bound(keys.starts.begin(), keys.starts.end(), first) - keys.starts.begin();
+    if (k == 0) {
+        hold(first, keys.starts[0] - 1, 0);
+    } else {
+        --k;
+    }
+    for (; k < key_count && keys.starts[k] <= last; ++k) {
+        hold(keys.starts[k], keys.ends[k], k);
+        if (k + 1 >= key_count) {
+            hold(keys.ends[k] + 1, last, k);
+        } else if (keys.connected[k]) {
+            interpolate(keys.ends[k] + 1, keys.starts[k + 1] - 1, k);
+        } else {
+            hold(keys.ends[k] + 1, keys.starts[k + 1] - 1, k);
+        }
+    }
+}
+
+} // namespace tl
\ No newline at end of file
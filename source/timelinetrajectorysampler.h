@@ -0,0 +1,70 @@
+#pragma once
+
+#include "timelinedef.h"
+#include "timelinelibexport.h"
+#include <span>
+#include <vector>
+
+namespace tl {
+
+class TimelineModel;
+
+// 将行内关键帧（条目）按帧展开为稠密采样数据。
+// 条目在[start, start + duration]内保持自身数值，若存在到下一条目的连接，则在两者之间插值，否则保持到下一条目开始。
+class TIMELINE_LIB_EXPORT TimelineTrajectorySampler {
+public:
+    enum class Interpolation {
+        Linear = 0,
+        Cubic
+    };
+
+    // 单行的采样结果，SoA布局：每个通道的所有帧连续存放
+    struct RowSamples {
+        int row { -1 };
+        int item_type { 0 };
+        int channel_count { 0 };
+        qint64 first_frame { 0 };
+        qint64 frame_count { 0 };
+        std::vector<double> values;
+
+        inline std::span<const double> channel(int index) const;
+        inline double value(int index, qint64 frame_no) const;
+    };
+
+    explicit TimelineTrajectorySampler(const TimelineModel* model);
+
+    void setInterpolation(Interpolation interpolation);
+    Interpolation interpolation() const;
+
+    // 最大并行线程数，0表示使用硬件并发数
+    void setMaxThreads(unsigned max_threads);
+    unsigned maxThreads() const;
+
+    // 采样单行[first, last]范围内的每一帧，不含可采样条目的行返回channel_count为0的结果
+    RowSamples sampleRow(int row, qint64 first, qint64 last) const;
+    // 采样所有行，各行并行计算，结果按行号顺序排列
+    std::vector<RowSamples> sample(qint64 first, qint64 last) const;
+
+private:
+    struct Keyframes;
+
+    Keyframes collectKeyframes(int row) const;
+    void evaluate(const Keyframes& keys, RowSamples& out) const;
+
+private:
+    const TimelineModel* model_ { nullptr };
+    Interpolation interpolation_ { Interpolation::Linear };
+    unsigned max_threads_ { 0 };
+};
+
+inline std::span<const double> TimelineTrajectorySampler::RowSamples::channel(int index) const
+{
+    return { values.data() + index * frame_count, static_cast<std::size_t>(frame_count) };
+}
+
+inline double TimelineTrajectorySampler::RowSamples::value(int index, qint64 frame_no) const
+{
+    return values[index * frame_count + (frame_no - first_frame)];
+}
+
+} // namespace tl
\ No newline at end of file
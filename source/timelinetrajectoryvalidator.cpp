@@ -0,0 +1,330 @@
+#include "timelinetrajectoryvalidator.h"
+#include "item/timelinearmitem.h"
+#include "timelinemodel.h"
+#include "timelineparallel.h"
+#include <cmath>
+#include <set>
+
+namespace tl {
+
+namespace {
+constexpr int kValidateRoles = TimelineItem::StartRole | TimelineItem::DurationRole | TimelineItem::EnabledRole | TimelineArmItem::JointAnglesRole;
+} // namespace
+
+// 单行Arm条目的快照，在GUI线程中生成，工作线程只访问快照
+struct TimelineTrajectoryValidator::RowSnapshot {
+    int row { -1 };
+    double fps { 24.0 };
+    std::vector<ItemID> item_ids;
+    std::vector<qint64> starts;
+    std::vector<qint64> ends;
+    // connected[k]表示第k个与第k+1个条目之间存在连接
+    std::vector<char> connected;
+    std::vector<std::size_t> joint_offsets;
+    std::vector<std::size_t> joint_counts;
+    std::vector<double> joints;
+};
+
+struct TimelineTrajectoryValidatorPrivate {
+    TimelineModel* model { nullptr };
+    std::vector<TimelineTrajectoryValidator::JointLimit> limits;
+    TimelineTrajectoryValidator::JointLimit default_limit;
+    unsigned max_threads { 0 };
+
+    // {row: violations}
+    std::map<int, std::vector<TimelineTrajectoryValidator::Violation>> violations;
+    std::set<int> dirty_rows;
+    bool validate_pending { false };
+};
+
+TimelineTrajectoryValidator::TimelineTrajectoryValidator(TimelineModel* model, QObject* parent)
+    : QObject(parent)
+    , d_(new TimelineTrajectoryValidatorPrivate)
+{
+    d_->model = model;
+
+    auto on_structure_changed = [this](ItemID item_id) {
+        if (TimelineModel::itemType(item_id) == TimelineArmItem::Type) {
+            markRowDirty(TimelineModel::itemRow(item_id));
+        }
+    };
+    connect(model, &TimelineModel::itemCreated, this, on_structure_changed);
+    connect(model, &TimelineModel::itemRemoved, this, on_structure_changed);
+    connect(model, &TimelineModel::itemChanged, this, &TimelineTrajectoryValidator::onItemChanged);
+    auto on_items_changed = [this, on_structure_changed](const QList<ItemID>& item_ids) {
+        for (ItemID item_id : item_ids) {
+            on_structure_changed(item_id);
+        }
+    };
+    connect(model, &TimelineModel::itemsCreated, this, on_items_changed);
+    connect(model, &TimelineModel::itemsRemoved, this, on_items_changed);
+    connect(model, &TimelineModel::itemsChanged, this, [this](const QList<ItemID>& item_ids, int role) {
+        for (ItemID item_id : item_ids) {
+            onItemChanged(item_id, role);
+        }
+    });
+    // 连接决定相邻条目之间是插值还是跳变
+    auto on_conn_changed = [on_structure_changed](const ItemConnID& conn_id) { on_structure_changed(conn_id.from); };
+    connect(model, &TimelineModel::itemConnCreated, this, on_conn_changed);
+    connect(model, &TimelineModel::itemConnRemoved, this, on_conn_changed);
+    // 与TimelineTrajectorySampler一致，禁用类型的条目不参与校验
+    connect(model, &TimelineModel::typeDisabledChanged, this, [this](int type) {
+        if (type == TimelineArmItem::Type) {
+            invalidate();
+        }
+    });
+    connect(model, &TimelineModel::fpsChanged, this, &TimelineTrajectoryValidator::invalidate);
+    connect(model, &TimelineModel::modelReset, this, &TimelineTrajectoryValidator::invalidate);
+    invalidate();
+}
+
+TimelineTrajectoryValidator::~TimelineTrajectoryValidator() noexcept
+{
+    delete d_;
+}
+
+TimelineModel* TimelineTrajectoryValidator::model() const
+{
+    return d_->model;
+}
+
+void TimelineTrajectoryValidator::setJointLimits(const std::vector<JointLimit>& limits)
+{
+    d_->limits = limits;
+    invalidate();
+}
+
+const std::vector<TimelineTrajectoryValidator::JointLimit>& TimelineTrajectoryValidator::jointLimits() const
+{
+    return d_->limits;
+}
+
+void TimelineTrajectoryValidator::setDefaultLimit(const JointLimit& limit)
+{
+    d_->default_limit = limit;
+    invalidate();
+}
+
+const TimelineTrajectoryValidator::JointLimit& TimelineTrajectoryValidator::defaultLimit() const
+{
+    return d_->default_limit;
+}
+
+void TimelineTrajectoryValidator::setMaxThreads(unsigned max_threads)
+{
+    d_->max_threads = max_threads;
+}
+
+unsigned TimelineTrajectoryValidator::maxThreads() const
+{
+    return d_->max_threads;
+}
+
+std::vector<TimelineTrajectoryValidator::Violation> TimelineTrajectoryValidator::violations()
+{
+    validate();
+    std::vector<Violation> result;
+    for (const auto& [_, row_violations] : d_->violations) {
+        result.insert(result.end(), row_violations.begin(), row_violations.end());
+    }
+    return result;
+}
+
+std::vector<TimelineTrajectoryValidator::Violation> TimelineTrajectoryValidator::rowViolations(int row)
+{
+    validate();
+    auto it = d_->violations.find(row);
+    if (it == d_->violations.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+bool TimelineTrajectoryValidator::isValid()
+{
+    validate();
+    return d_->violations.empty();
+}
+
+void TimelineTrajectoryValidator::validate()
+{
+    d_->validate_pending = false;
+    if (d_->dirty_rows.empty()) {
+        return;
+    }
+
+    std::vector<RowSnapshot> snapshots;
+    snapshots.reserve(d_->dirty_rows.size());
+    for (int row : d_->dirty_rows) {
+        snapshots.emplace_back(snapshotRow(row));
+    }
+    d_->dirty_rows.clear();
+
+    std::vector<std::vector<Violation>> results(snapshots.size());
+    TimelineParallel::forEach(
+        snapshots.size(),
+        [&](std::size_t i) { results[i] = validateRow(snapshots[i]); },
+        d_->max_threads);
+
+    bool changed = false;
+    for (std::size_t i = 0; i < snapshots.size(); ++i) {
+        int row = snapshots[i].row;
+        auto it = d_->violations.find(row);
+        bool had_violations = it != d_->violations.end();
+        if (results[i].empty()) {
+            if (had_violations) {
+                d_->violations.erase(it);
+                changed = true;
+            }
+            continue;
+        }
+        d_->violations[row] = std::move(results[i]);
+        changed = true;
+    }
+
+    if (changed) {
+        emit violationsChanged();
+    }
+}
+
+void TimelineTrajectoryValidator::invalidate()
+{
+    for (int row = 0; row < d_->model->rowCount(); ++row) {
+        d_->dirty_rows.emplace(row);
+    }
+    for (const auto& [row, _] : d_->violations) {
+        d_->dirty_rows.emplace(row);
+    }
+    scheduleValidate();
+}
+
+void TimelineTrajectoryValidator::onItemChanged(ItemID item_id, int role)
+{
+    if (TimelineModel::itemType(item_id) == TimelineArmItem::Type && (role & kValidateRoles)) {
+        markRowDirty(TimelineModel::itemRow(item_id));
+    }
+}
+
+void TimelineTrajectoryValidator::markRowDirty(int row)
+{
+    d_->dirty_rows.emplace(row);
+    scheduleValidate();
+}
+
+void TimelineTrajectoryValidator::scheduleValidate()
+{
+    if (d_->validate_pending) {
+        return;
+    }
+    d_->validate_pending = true;
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            if (d_->validate_pending) {
+                validate();
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+TimelineTrajectoryValidator::RowSnapshot TimelineTrajectoryValidator::snapshotRow(int row) const
+{
+    RowSnapshot snapshot;
+    snapshot.row = row;
+    snapshot.fps = d_->model->fps();
+    for (const auto& [_, item_id] : d_->model->rowItemRange(row)) {
+        if (TimelineModel::itemType(item_id) != TimelineArmItem::Type) {
+            continue;
+        }
+        auto* item = d_->model->item<TimelineArmItem>(item_id);
+        if (!item || !item->isEnabled() || d_->model->isItemDisabled(item_id)) {
+            continue;
+        }
+        const auto& angles = item->angles();
+        snapshot.item_ids.emplace_back(item_id);
+        snapshot.starts.emplace_back(item->start());
+        snapshot.ends.emplace_back(item->end());
+        snapshot.joint_offsets.emplace_back(snapshot.joints.size());
+        snapshot.joint_counts.emplace_back(angles.size());
+        snapshot.joints.insert(snapshot.joints.end(), angles.begin(), angles.end());
+    }
+    // 与TimelineTrajectorySampler相同，按相邻条目之间是否存在连接区分插值与跳变
+    snapshot.connected.resize(snapshot.item_ids.size(), 0);
+    for (std::size_t k = 0; k + 1 < snapshot.item_ids.size(); ++k) {
+        snapshot.connected[k] = d_->model->nextConnection(snapshot.item_ids[k]).to == snapshot.item_ids[k + 1];
+    }
+    return snapshot;
+}
+
+std::vector<TimelineTrajectoryValidator::Violation> TimelineTrajectoryValidator::validateRow(const RowSnapshot& snapshot) const
+{
+    std::vector<Violation> result;
+    const std::size_t count = snapshot.item_ids.size();
+    if (count < 2 || snapshot.fps <= 0) {
+        return result;
+    }
+
+    // 第k个运动区间：有连接时为第k个条目停留结束 -> 第k+1个条目开始；
+    // 没有连接时采样保持到第k+1个条目开始的前一帧，运动为一帧内的跳变
+    auto travel_secs = [&](std::size_t k) {
+        if (!snapshot.connected[k]) {
+            return 1.0 / snapshot.fps;
+        }
+        return static_cast<double>(snapshot.starts[k + 1] - snapshot.ends[k]) / snapshot.fps;
+    };
+    auto travel_mid_secs = [&](std::size_t k) {
+        if (!snapshot.connected[k]) {
+            return (static_cast<double>(snapshot.starts[k + 1]) - 0.5) / snapshot.fps;
+        }
+        return static_cast<double>(snapshot.starts[k + 1] + snapshot.ends[k]) / 2.0 / snapshot.fps;
+    };
+    auto joint_count = [&](std::size_t k) {
+        return std::min(snapshot.joint_counts[k], snapshot.joint_counts[k + 1]);
+    };
+    auto velocity = [&](std::size_t k, std::size_t joint) {
+        double delta = snapshot.joints[snapshot.joint_offsets[k + 1] + joint] - snapshot.joints[snapshot.joint_offsets[k] + joint];
+        return delta / travel_secs(k);
+    };
+
+    for (std::size_t k = 0; k + 1 < count; ++k) {
+        if (travel_secs(k) <= 0) {
+            continue;
+        }
+        for (std::size_t joint = 0; joint < joint_count(k); ++joint) {
+            const auto& joint_limit = limit(static_cast<int>(joint));
+            double v = velocity(k, joint);
+            if (std::abs(v) > joint_limit.max_velocity) {
+                result.emplace_back(Violation { .item_id = snapshot.item_ids[k + 1],
+                    .from_item_id = snapshot.item_ids[k],
+                    .joint = static_cast<int>(joint),
+                    .kind = ViolationKind::Velocity,
+                    .value = v,
+                    .limit = joint_limit.max_velocity });
+            }
+
+            if (k + 2 >= count || joint >= joint_count(k + 1) || travel_secs(k + 1) <= 0) {
+                continue;
+            }
+            double a = (velocity(k + 1, joint) - v) / (travel_mid_secs(k + 1) - travel_mid_secs(k));
+            if (std::abs(a) > joint_limit.max_acceleration) {
+                result.emplace_back(Violation { .item_id = snapshot.item_ids[k + 1],
+                    .from_item_id = snapshot.item_ids[k],
+                    .joint = static_cast<int>(joint),
+                    .kind = ViolationKind::Acceleration,
+                    .value = a,
+                    .limit = joint_limit.max_acceleration });
+            }
+        }
+    }
+    return result;
+}
+
+const TimelineTrajectoryValidator::JointLimit& TimelineTrajectoryValidator::limit(int joint) const
+{
+    if (joint < static_cast<int>(d_->limits.size())) {
+        return d_->limits[joint];
+    }
+    return d_->default_limit;
+}
+
+} // namespace tl
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "timelinedef.h"
+#include "timelinelibexport.h"
+#include <QObject>
+#include <limits>
+#include <vector>
+
+namespace tl {
+
+class TimelineModel;
+struct TimelineTrajectoryValidatorPrivate;
+
+// 校验相邻Arm条目关节角度与帧间隔隐含的关节速度和加速度是否超限。
+// 速度按前一条目停留结束到后一条目开始的运动区间计算，没有连接的相邻条目与采样一致视为一帧内的跳变；
+// 加速度为相邻两个运动区间的速度差除以两区间中点的时间差。
+// 模型修改后只重新校验受影响的行，同一事件循环周期内的修改合并为一次校验，各行并行计算。
+class TIMELINE_LIB_EXPORT TimelineTrajectoryValidator : public QObject {
+    Q_OBJECT
+public:
+    // 单位：角度/秒、角度/秒²
+    struct JointLimit {
+        double max_velocity { std::numeric_limits<double>::infinity() };
+        double max_acceleration { std::numeric_limits<double>::infinity() };
+    };
+
+    enum class ViolationKind {
+        Velocity = 0,
+        Acceleration
+    };
+
+    struct Violation {
+        // 运动到达的条目，加速度超限时为两个运动区间之间的条目
+        ItemID item_id { kInvalidItemID };
+        // 运动出发的条目
+        ItemID from_item_id { kInvalidItemID };
+        int joint { 0 };
+        ViolationKind kind { ViolationKind::Velocity };
+        double value { 0 };
+        double limit { 0 };
+    };
+
+    explicit TimelineTrajectoryValidator(TimelineModel* model, QObject* parent = nullptr);
+    ~TimelineTrajectoryValidator() noexcept override;
+
+    TimelineModel* model() const;
+
+    // 第i个元素为第i个关节的限制，未配置的关节使用defaultLimit()
+    void setJointLimits(const std::vector<JointLimit>& limits);
+    const std::vector<JointLimit>& jointLimits() const;
+    void setDefaultLimit(const JointLimit& limit);
+    const JointLimit& defaultLimit() const;
+
+    // 最大并行线程数，0表示使用硬件并发数
+    void setMaxThreads(unsigned max_threads);
+    unsigned maxThreads() const;
+
+    // 按行号顺序返回所有超限项，调用前会先处理待校验的修改
+    std::vector<Violation> violations();
+    std::vector<Violation> rowViolations(int row);
+    bool isValid();
+
+    // 立即校验所有待校验的行
+    void validate();
+    // 所有行重新校验
+    void invalidate();
+
+signals:
+    void violationsChanged();
+
+private:
+    struct RowSnapshot;
+
+    void onItemChanged(ItemID item_id, int role);
+    void markRowDirty(int row);
+    void scheduleValidate();
+
+    RowSnapshot snapshotRow(int row) const;
+    std::vector<Violation> validateRow(const RowSnapshot& snapshot) const;
+    const JointLimit& limit(int joint) const;
+
+private:
+    TimelineTrajectoryValidatorPrivate* d_ { nullptr };
+};
+
+} // namespace tl
\ No newline at end of file
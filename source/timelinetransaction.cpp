@@ -2,48 +2,128 @@
 #include "item/timelineitem.h"
 #include "timelinemodel.h"
 #include <QCoreApplication>
+#include <QDateTime>
 
 namespace tl {
-TimelineItemCreateCommand::TimelineItemCreateCommand(TimelineModel* model, ItemID item_id, QUndoCommand* parent)
+namespace {
+// 连续移动合并的时间窗口
+constexpr qint64 kMoveMergeWindowMs = 500;
+} // namespace
+
+TimelineUndoCommand::TimelineUndoCommand(QUndoCommand* parent)
     : QUndoCommand(parent)
+{
+}
+
+std::size_t TimelineUndoCommand::byteSize() const
+{
+    return sizeof(*this);
+}
+
+void TimelineUndoCommand::release()
+{
+    released_ = true;
+    setObsolete(true);
+}
+
+TimelineItemRecord TimelineItemRecord::capture(const TimelineModel* model, ItemID item_id)
+{
+    TimelineItemRecord record;
+    if (!model->exists(item_id)) {
+        return record;
+    }
+    record.item_id = item_id;
+    record.with_connection = model->hasConnection(item_id);
+    nlohmann::json::to_msgpack(model->itemData(item_id), record.data);
+    record.data.shrink_to_fit();
+    return record;
+}
+
+void TimelineItemRecord::restore(TimelineModel* model) const
+{
+    if (item_id == kInvalidItemID) {
+        return;
+    }
+    model->loadItemData(item_id, nlohmann::json::from_msgpack(data), with_connection);
+}
+
+bool TimelineItemRecord::restore(TimelineModel* model, std::span<const TimelineItemRecord> records)
+{
+    return model->restoreItems(records);
+}
+
+TimelineItemCreateCommand::TimelineItemCreateCommand(TimelineModel* model, ItemID item_id, QUndoCommand* parent)
+    : TimelineUndoCommand(parent)
     , model_(model)
-    , item_id_(item_id)
-    , item_data_(model->saveItem(item_id))
+    , record_(TimelineItemRecord::capture(model, item_id))
 {
     setText(QCoreApplication::translate("TimelineItemCreateCommand", "Create Item"));
 }
 
 void TimelineItemCreateCommand::undo()
 {
-    model_->removeItem(item_id_);
+    if (isReleased()) {
+        return;
+    }
+    model_->removeItem(record_.item_id);
 }
 
 void TimelineItemCreateCommand::redo()
 {
-    model_->loadItem(item_data_);
+    if (isReleased()) {
+        return;
+    }
+    record_.restore(model_);
+}
+
+std::size_t TimelineItemCreateCommand::byteSize() const
+{
+    return sizeof(*this) + record_.data.capacity();
+}
+
+void TimelineItemCreateCommand::release()
+{
+    TimelineUndoCommand::release();
+    record_ = {};
 }
 
 TimelineItemDeleteCommand::TimelineItemDeleteCommand(TimelineModel* model, ItemID item_id, QUndoCommand* parent)
-    : QUndoCommand(parent)
+    : TimelineUndoCommand(parent)
     , model_(model)
-    , item_id_(item_id)
-    , item_data_(model_->saveItem(item_id_))
+    , record_(TimelineItemRecord::capture(model, item_id))
 {
     setText(QCoreApplication::translate("TimelineItemDeleteCommand", "Delete Item"));
 }
 
 void TimelineItemDeleteCommand::undo()
 {
-    model_->loadItem(item_data_);
+    if (isReleased()) {
+        return;
+    }
+    record_.restore(model_);
 }
 
 void TimelineItemDeleteCommand::redo()
 {
-    model_->removeItem(item_id_);
+    if (isReleased()) {
+        return;
+    }
+    model_->removeItem(record_.item_id);
+}
+
+std::size_t TimelineItemDeleteCommand::byteSize() const
+{
+    return sizeof(*this) + record_.data.capacity();
+}
+
+void TimelineItemDeleteCommand::release()
+{
+    TimelineUndoCommand::release();
+    record_ = {};
 }
 
 TimelineItemMoveCommand::TimelineItemMoveCommand(TimelineModel* model, ItemID item_id, qint64 old_start, QUndoCommand* parent)
-    : QUndoCommand(parent)
+    : TimelineUndoCommand(parent)
     , model_(model)
     , item_id_(item_id)
     , old_start_(old_start)
@@ -51,6 +131,7 @@ TimelineItemMoveCommand::TimelineItemMoveCommand(TimelineModel* model, ItemID it
     if (auto* item = model_->item(item_id_); item) {
         new_start_ = item->start();
     }
+    timestamp_ = QDateTime::currentMSecsSinceEpoch();
 
     setText(QCoreApplication::translate("TimelineItemMoveCommand", "Move Item"));
 }
@@ -73,4 +154,202 @@ void TimelineItemMoveCommand::redo()
     }
 }
 
+bool TimelineItemMoveCommand::mergeWith(const QUndoCommand* other)
+{
+    auto* move_command = static_cast<const TimelineItemMoveCommand*>(other);
+    if (move_command->item_id_ != item_id_ || move_command->model_ != model_ || move_command->timestamp_ - timestamp_ > kMoveMergeWindowMs) {
+        return false;
+    }
+    new_start_ = move_command->new_start_;
+    timestamp_ = move_command->timestamp_;
+    // 移回原位后整条命令不再有意义，由QUndoStack删除
+    setObsolete(new_start_ == old_start_);
+    return true;
+}
+
+namespace {
+std::size_t recordsByteSize(const std::vector<TimelineItemRecord>& records)
+{
+    std::size_t size = records.capacity() * sizeof(TimelineItemRecord);
+    for (const auto& record : records) {
+        size += record.data.capacity();
+    }
+    return size;
+}
+} // namespace
+
+TimelineItemsDeleteCommand::TimelineItemsDeleteCommand(TimelineModel* model, const QList<ItemID>& item_ids, QUndoCommand* parent)
+    : TimelineUndoCommand(parent)
+    , model_(model)
+    , item_ids_(item_ids)
+{
+    records_.reserve(item_ids_.size());
+    for (ItemID item_id : item_ids_) {
+        if (auto record = TimelineItemRecord::capture(model_, item_id); record.item_id != kInvalidItemID) {
+            records_.emplace_back(std::move(record));
+        }
+    }
+    setText(QCoreApplication::translate("TimelineItemsDeleteCommand", "Delete %n Item(s)", nullptr, static_cast<int>(records_.size())));
+}
+
+void TimelineItemsDeleteCommand::undo()
+{
+    if (isReleased()) {
+        return;
+    }
+    TimelineItemRecord::restore(model_, records_);
+}
+
+void TimelineItemsDeleteCommand::redo()
+{
+    if (isReleased()) {
+        return;
+    }
+    model_->removeItems(item_ids_);
+}
+
+std::size_t TimelineItemsDeleteCommand::byteSize() const
+{
+    return sizeof(*this) + item_ids_.size() * sizeof(ItemID) + recordsByteSize(records_);
+}
+
+void TimelineItemsDeleteCommand::release()
+{
+    TimelineUndoCommand::release();
+    item_ids_ = {};
+    records_ = {};
+}
+
+TimelineItemsMoveCommand::TimelineItemsMoveCommand(TimelineModel* model, const QList<ItemID>& item_ids, qint64 delta, QUndoCommand* parent)
+    : TimelineUndoCommand(parent)
+    , model_(model)
+    , item_ids_(item_ids)
+    , delta_(delta)
+    , timestamp_(QDateTime::currentMSecsSinceEpoch())
+{
+    setText(QCoreApplication::translate("TimelineItemsMoveCommand", "Move %n Item(s)", nullptr, static_cast<int>(item_ids_.size())));
+}
+
+void TimelineItemsMoveCommand::undo()
+{
+    if (isReleased()) {
+        return;
+    }
+    model_->moveItems(item_ids_, -delta_);
+}
+
+void TimelineItemsMoveCommand::redo()
+{
+    if (isReleased()) {
+        return;
+    }
+    if (!applied_) {
+        // 首次执行时确定实际平移量，之后按该值重做
+        delta_ = model_->moveItems(item_ids_, delta_);
+        applied_ = true;
+        setObsolete(delta_ == 0);
+        return;
+    }
+    model_->moveItems(item_ids_, delta_);
+}
+
+bool TimelineItemsMoveCommand::mergeWith(const QUndoCommand* other)
+{
+    auto* move_command = static_cast<const TimelineItemsMoveCommand*>(other);
+    if (move_command->model_ != model_ || move_command->timestamp_ - timestamp_ > kMoveMergeWindowMs || move_command->item_ids_ != item_ids_) {
+        return false;
+    }
+    delta_ += move_command->delta_;
+    timestamp_ = move_command->timestamp_;
+    setObsolete(delta_ == 0);
+    return true;
+}
+
+std::size_t TimelineItemsMoveCommand::byteSize() const
+{
+    return sizeof(*this) + item_ids_.size() * sizeof(ItemID);
+}
+
+void TimelineItemsMoveCommand::release()
+{
+    TimelineUndoCommand::release();
+    item_ids_ = {};
+}
+
+TimelineItemsPasteCommand::TimelineItemsPasteCommand(TimelineModel* model, const QString& data, qint64 frame_no, QUndoCommand* parent)
+    : TimelineUndoCommand(parent)
+    , model_(model)
+    , data_(data)
+    , frame_no_(frame_no)
+{
+    setText(QCoreApplication::translate("TimelineItemsPasteCommand", "Paste Items"));
+}
+
+void TimelineItemsPasteCommand::undo()
+{
+    if (isReleased()) {
+        return;
+    }
+    if (records_.empty()) {
+        records_.reserve(item_ids_.size());
+        for (ItemID item_id : item_ids_) {
+            records_.emplace_back(TimelineItemRecord::capture(model_, item_id));
+        }
+        // 之后的重做直接从记录恢复
+        data_.clear();
+        data_.squeeze();
+    }
+    model_->removeItems(item_ids_);
+}
+
+void TimelineItemsPasteCommand::redo()
+{
+    if (isReleased()) {
+        return;
+    }
+    if (!records_.empty()) {
+        TimelineItemRecord::restore(model_, records_);
+        return;
+    }
+    item_ids_ = model_->pasteItems(data_, frame_no_);
+    setObsolete(item_ids_.isEmpty());
+}
+
+std::size_t TimelineItemsPasteCommand::byteSize() const
+{
+    return sizeof(*this) + static_cast<std::size_t>(data_.capacity()) * sizeof(QChar) + item_ids_.size() * sizeof(ItemID) + recordsByteSize(records_);
+}
+
+void TimelineItemsPasteCommand::release()
+{
+    TimelineUndoCommand::release();
+    data_.clear();
+    data_.squeeze();
+    item_ids_ = {};
+    records_ = {};
+}
+
+TimelineRippleCommand::TimelineRippleCommand(TimelineModel* model, int row, qint64 from_frame, qint64 delta, QUndoCommand* parent)
+    : TimelineUndoCommand(parent)
+    , model_(model)
+    , row_(row)
+    , from_frame_(from_frame)
+    , delta_(delta)
+{
+    setText(delta_ > 0 ? QCoreApplication::translate("TimelineRippleCommand", "Insert Time") : QCoreApplication::translate("TimelineRippleCommand", "Remove Time"));
+}
+
+void TimelineRippleCommand::undo()
+{
+    model_->rippleShift(row_, from_frame_ + delta_, -delta_);
+}
+
+void TimelineRippleCommand::redo()
+{
+    // 平移被拒绝时命令没有意义，由QUndoStack删除
+    if (!model_->rippleShift(row_, from_frame_, delta_)) {
+        setObsolete(true);
+    }
+}
+
 } // namespace tl
\ No newline at end of file
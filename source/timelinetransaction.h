@@ -2,39 +2,81 @@
 
 #include "nlohmann/json.hpp"
 #include "timelinedef.h"
+#include <QList>
 #include <QUndoCommand>
+#include <span>
 
 namespace tl {
 
 class TimelineModel;
 
-class TimelineItemCreateCommand : public QUndoCommand {
+// 撤销命令的公共基类，byteSize()用于撤销历史的内存预算
+class TimelineUndoCommand : public QUndoCommand {
+public:
+    explicit TimelineUndoCommand(QUndoCommand* parent = nullptr);
+
+    // 命令当前占用的内存，包括自身持有的数据
+    virtual std::size_t byteSize() const;
+
+    // 超出预算时由TimelineScene调用，释放数据后命令不能再撤销，并标记为失效使QUndoStack撤销到它时将其删除
+    virtual void release();
+    inline bool isReleased() const
+    {
+        return released_;
+    }
+
+private:
+    bool released_ { false };
+};
+
+// 条目的紧凑记录：数据以MessagePack编码保存，不保留JSON树
+struct TimelineItemRecord {
+    ItemID item_id { kInvalidItemID };
+    bool with_connection { false };
+    std::vector<std::uint8_t> data;
+
+    static TimelineItemRecord capture(const TimelineModel* model, ItemID item_id);
+    void restore(TimelineModel* model) const;
+    // 一次批量操作恢复全部记录
+    static bool restore(TimelineModel* model, std::span<const TimelineItemRecord> records);
+
+    inline std::size_t byteSize() const
+    {
+        return sizeof(*this) + data.capacity();
+    }
+};
+
+class TimelineItemCreateCommand : public TimelineUndoCommand {
 public:
     explicit TimelineItemCreateCommand(TimelineModel* model, ItemID item_id, QUndoCommand* parent = nullptr);
 
     void undo() override;
     void redo() override;
 
+    std::size_t byteSize() const override;
+    void release() override;
+
 private:
     TimelineModel* model_ { nullptr };
-    ItemID item_id_ { kInvalidItemID };
-    nlohmann::json item_data_;
+    TimelineItemRecord record_;
 };
 
-class TimelineItemDeleteCommand : public QUndoCommand {
+class TimelineItemDeleteCommand : public TimelineUndoCommand {
 public:
     explicit TimelineItemDeleteCommand(TimelineModel* model, ItemID item_id, QUndoCommand* parent = nullptr);
 
     void undo() override;
     void redo() override;
 
+    std::size_t byteSize() const override;
+    void release() override;
+
 private:
     TimelineModel* model_ { nullptr };
-    ItemID item_id_ { kInvalidItemID };
-    nlohmann::json item_data_;
+    TimelineItemRecord record_;
 };
 
-class TimelineItemMoveCommand : public QUndoCommand {
+class TimelineItemMoveCommand : public TimelineUndoCommand {
 public:
     constexpr static int kID = 10;
 
@@ -53,11 +95,101 @@ public:
         return kID;
     }
 
+    // 同一条目在时间窗口内的连续移动合并为一条命令，撤销时直接回到最初位置
+    bool mergeWith(const QUndoCommand* other) override;
+
 private:
     TimelineModel* model_ { nullptr };
     ItemID item_id_ { kInvalidItemID };
     qint64 old_start_ { -1 };
     qint64 new_start_ { -1 };
+    // 最近一次移动的时间，毫秒
+    qint64 timestamp_ { 0 };
+};
+
+// 多个条目的宏命令，通过TimelineModel的批量操作执行，撤销与重做的开销与条目数成正比
+class TimelineItemsDeleteCommand : public TimelineUndoCommand {
+public:
+    explicit TimelineItemsDeleteCommand(TimelineModel* model, const QList<ItemID>& item_ids, QUndoCommand* parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+    std::size_t byteSize() const override;
+    void release() override;
+
+private:
+    TimelineModel* model_ { nullptr };
+    QList<ItemID> item_ids_;
+    std::vector<TimelineItemRecord> records_;
+};
+
+// 压入撤销栈时执行平移，实际平移量可能因相邻条目而收缩
+class TimelineItemsMoveCommand : public TimelineUndoCommand {
+public:
+    constexpr static int kID = 11;
+
+    explicit TimelineItemsMoveCommand(TimelineModel* model, const QList<ItemID>& item_ids, qint64 delta, QUndoCommand* parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+    int id() const override
+    {
+        return kID;
+    }
+
+    // 同一组条目在时间窗口内的连续平移合并为一条命令
+    bool mergeWith(const QUndoCommand* other) override;
+
+    std::size_t byteSize() const override;
+    void release() override;
+
+private:
+    TimelineModel* model_ { nullptr };
+    QList<ItemID> item_ids_;
+    qint64 delta_ { 0 };
+    bool applied_ { false };
+    qint64 timestamp_ { 0 };
+};
+
+// 压入撤销栈时粘贴，撤销时记录条目数据以便重做
+class TimelineItemsPasteCommand : public TimelineUndoCommand {
+public:
+    explicit TimelineItemsPasteCommand(TimelineModel* model, const QString& data, qint64 frame_no, QUndoCommand* parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+    inline const QList<ItemID>& itemIds() const
+    {
+        return item_ids_;
+    }
+
+    std::size_t byteSize() const override;
+    void release() override;
+
+private:
+    TimelineModel* model_ { nullptr };
+    QString data_;
+    qint64 frame_no_ { 0 };
+    QList<ItemID> item_ids_;
+    std::vector<TimelineItemRecord> records_;
+};
+
+// 波纹编辑，压入撤销栈时执行，撤销时从平移后的位置反向平移
+class TimelineRippleCommand : public TimelineUndoCommand {
+public:
+    explicit TimelineRippleCommand(TimelineModel* model, int row, qint64 from_frame, qint64 delta, QUndoCommand* parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+private:
+    TimelineModel* model_ { nullptr };
+    int row_ { -1 };
+    qint64 from_frame_ { 0 };
+    qint64 delta_ { 0 };
 };
 
 } // namespace tl
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include "timelinetransport.h"
+#include "timelinemodel.h"
+#include <QTimer>
+#include <cmath>
+
+namespace tl {
+
+struct TimelineTransportPrivate {
+    TimelineModel* model { nullptr };
+    QTimer* timer { nullptr };
+
+    bool playing { false };
+    bool resume_after_scrub { false };
+    bool auto_scroll { true };
+    double rate { 1.0 };
+    qint64 frame { 0 };
+    qint64 dropped_frames { 0 };
+
+    bool looping { false };
+    qint64 loop_first { 0 };
+    qint64 loop_last { 0 };
+
+    // 时钟锚点，所有帧号都由锚点和稳定时钟推算，避免累计误差
+    TimelineTransport::Clock::time_point anchor_time;
+    qint64 anchor_frame { 0 };
+};
+
+TimelineTransport::TimelineTransport(TimelineModel* model, QObject* parent)
+    : QObject(parent)
+    , d_(new TimelineTransportPrivate)
+{
+    d_->model = model;
+    d_->frame = model->frameMinimum();
+    d_->anchor_time = Clock::now();
+    d_->anchor_frame = d_->frame;
+
+    d_->timer = new QTimer(this);
+    d_->timer->setSingleShot(true);
+    d_->timer->setTimerType(Qt::PreciseTimer);
+    connect(d_->timer, &QTimer::timeout, this, &TimelineTransport::onTimeout);
+    connect(model, &TimelineModel::fpsChanged, this, &TimelineTransport::onFpsChanged);
+}
+
+TimelineTransport::~TimelineTransport() noexcept
+{
+    delete d_;
+}
+
+TimelineModel* TimelineTransport::model() const
+{
+    return d_->model;
+}
+
+void TimelineTransport::play()
+{
+    if (d_->playing) {
+        return;
+    }
+    if (d_->frame < playFirst() || d_->frame >= playLast()) {
+        d_->frame = playFirst();
+        emit frameTick(d_->frame);
+    }
+    d_->playing = true;
+    d_->dropped_frames = 0;
+    reanchor(d_->frame);
+    scheduleNextTick();
+    emit playingChanged(true);
+}
+
+void TimelineTransport::pause()
+{
+    if (!d_->playing) {
+        return;
+    }
+    d_->playing = false;
+    d_->timer->stop();
+    emit playingChanged(false);
+}
+
+void TimelineTransport::stop()
+{
+    pause();
+    seek(playFirst());
+}
+
+void TimelineTransport::togglePlay()
+{
+    if (d_->playing) {
+        pause();
+    } else {
+        play();
+    }
+}
+
+bool TimelineTransport::isPlaying() const
+{
+    return d_->playing;
+}
+
+void TimelineTransport::seek(qint64 frame_no)
+{
+    frame_no = qBound(d_->model->frameMinimum(), frame_no, d_->model->frameMaximum());
+    d_->frame = frame_no;
+    reanchor(frame_no);
+    if (d_->auto_scroll) {
+        scrollToFrame(frame_no);
+    }
+    emit frameTick(frame_no);
+    if (d_->playing) {
+        scheduleNextTick();
+    }
+}
+
+qint64 TimelineTransport::frame() const
+{
+    return d_->frame;
+}
+
+void TimelineTransport::setRate(double rate)
+{
+    if (rate <= 0 || qFuzzyCompare(rate, d_->rate)) {
+        return;
+    }
+    d_->rate = rate;
+    reanchor(d_->frame);
+    if (d_->playing) {
+        scheduleNextTick();
+    }
+    emit rateChanged(rate);
+}
+
+double TimelineTransport::rate() const
+{
+    return d_->rate;
+}
+
+void TimelineTransport::setLoopRange(qint64 first, qint64 last)
+{
+    if (last <= first) {
+        TL_LOG_ERROR("Invalid loop range [{}, {}]", first, last);
+        return;
+    }
+    d_->looping = true;
+    d_->loop_first = first;
+    d_->loop_last = last;
+    emit loopRangeChanged(first, last);
+}
+
+void TimelineTransport::clearLoopRange()
+{
+    if (!d_->looping) {
+        return;
+    }
+    d_->looping = false;
+    emit loopRangeChanged(d_->model->frameMinimum(), d_->model->frameMaximum());
+}
+
+bool TimelineTransport::isLooping() const
+{
+    return d_->looping;
+}
+
+qint64 TimelineTransport::loopFirst() const
+{
+    return d_->loop_first;
+}
+
+qint64 TimelineTransport::loopLast() const
+{
+    return d_->loop_last;
+}
+
+void TimelineTransport::setAutoScroll(bool enabled)
+{
+    d_->auto_scroll = enabled;
+}
+
+bool TimelineTransport::autoScroll() const
+{
+    return d_->auto_scroll;
+}
+
+void TimelineTransport::beginScrub()
+{
+    d_->resume_after_scrub = d_->playing;
+    pause();
+}
+
+void TimelineTransport::endScrub(qint64 frame_no)
+{
+    seek(frame_no);
+    if (d_->resume_after_scrub) {
+        d_->resume_after_scrub = false;
+        play();
+    }
+}
+
+TimelineTransport::Clock::time_point TimelineTransport::anchorTime() const
+{
+    return d_->anchor_time;
+}
+
+qint64 TimelineTransport::anchorFrame() const
+{
+    return d_->anchor_frame;
+}
+
+qint64 TimelineTransport::droppedFrames() const
+{
+    return d_->dropped_frames;
+}
+
+void TimelineTransport::onTimeout()
+{
+    if (!d_->playing) {
+        return;
+    }
+
+    qint64 target = frameAt(Clock::now());
+    const qint64 first = playFirst();
+    const qint64 last = playLast();
+    bool finished = false;
+    if (target > last) {
+        if (d_->looping) {
+            // 回绕时同步平移锚点，保持时钟相位不变
+            const qint64 length = last - first + 1;
+            const qint64 loops = (target - first) / length;
+            target -= loops * length;
+            d_->anchor_frame -= loops * length;
+        } else {
+            target = last;
+            finished = true;
+        }
+    }
+
+    if (target == d_->frame && !finished) {
+        scheduleNextTick();
+        return;
+    }
+
+    // 落后时直接跳帧，不逐帧追赶
+    if (target > d_->frame + 1) {
+        d_->dropped_frames += target - d_->frame - 1;
+    }
+    d_->frame = target;
+    if (d_->auto_scroll) {
+        scrollToFrame(target);
+    }
+    emit frameTick(target);
+
+    if (finished) {
+        pause();
+    } else {
+        scheduleNextTick();
+    }
+}
+
+void TimelineTransport::onFpsChanged()
+{
+    reanchor(d_->frame);
+    if (d_->playing) {
+        scheduleNextTick();
+    }
+}
+
+void TimelineTransport::reanchor(qint64 frame_no)
+{
+    d_->anchor_time = Clock::now();
+    d_->anchor_frame = frame_no;
+    emit anchorChanged();
+}
+
+void TimelineTransport::scheduleNextTick()
+{
+    auto remaining = timeOfFrame(d_->frame + 1) - Clock::now();
+    auto msecs = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+    d_->timer->start(static_cast<int>(qMax<qint64>(0, msecs)));
+}
+
+void TimelineTransport::scrollToFrame(qint64 frame_no)
+{
+    const qint64 view_min = d_->model->viewFrameMinimum();
+    const qint64 view_max = d_->model->viewFrameMaximum();
+    if (frame_no >= view_min && frame_no <= view_max) {
+        return;
+    }
+
+    // 按页滚动，播放头落在新视图范围的起始位置
+    const qint64 span = view_max - view_min;
+    qint64 new_min = qBound(d_->model->frameMinimum(), frame_no, qMax(d_->model->frameMinimum(), d_->model->frameMaximum() - span));
+    if (new_min > view_min) {
+        d_->model->setViewFrameMaximum(new_min + span);
+        d_->model->setViewFrameMinimum(new_min);
+    } else {
+        d_->model->setViewFrameMinimum(new_min);
+        d_->model->setViewFrameMaximum(new_min + span);
+    }
+}
+
+qint64 TimelineTransport::frameAt(Clock::time_point time_point) const
+{
+    const double elapsed = std::chrono::duration<double>(time_point - d_->anchor_time).count();
+    return d_->anchor_frame + static_cast<qint64>(std::floor(elapsed * d_->model->fps() * d_->rate));
+}
+
+TimelineTransport::Clock::time_point TimelineTransport::timeOfFrame(qint64 frame_no) const
+{
+    const double secs = static_cast<double>(frame_no - d_->anchor_frame) / (d_->model->fps() * d_->rate);
+    return d_->anchor_time + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(secs));
+}
+
+qint64 TimelineTransport::playFirst() const
+{
+    return d_->looping ? d_->loop_first : d_->model->frameMinimum();
+}
+
+qint64 TimelineTransport::playLast() const
+{
+    return d_->looping ? d_->loop_last : d_->model->frameMaximum();
+}
+
+} // namespace tl
\ No newline at end of file
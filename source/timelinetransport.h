@@ -0,0 +1,77 @@
+#pragma once
+
+#include "timelinedef.h"
+#include "timelinelibexport.h"
+#include <QObject>
+#include <chrono>
+
+namespace tl {
+
+class TimelineModel;
+struct TimelineTransportPrivate;
+
+class TIMELINE_LIB_EXPORT TimelineTransport : public QObject {
+    Q_OBJECT
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TimelineTransport(TimelineModel* model, QObject* parent = nullptr);
+    ~TimelineTransport() noexcept override;
+
+    TimelineModel* model() const;
+
+    void play();
+    void pause();
+    void stop();
+    void togglePlay();
+    bool isPlaying() const;
+
+    void seek(qint64 frame_no);
+    qint64 frame() const;
+
+    void setRate(double rate);
+    double rate() const;
+
+    void setLoopRange(qint64 first, qint64 last);
+    void clearLoopRange();
+    bool isLooping() const;
+    qint64 loopFirst() const;
+    qint64 loopLast() const;
+
+    void setAutoScroll(bool enabled);
+    bool autoScroll() const;
+
+    // 拖动播放头期间暂停时钟，释放后从新位置继续
+    void beginScrub();
+    void endScrub(qint64 frame_no);
+
+    // 当前时钟锚点：anchorTime()时刻对应anchorFrame()帧，供其他线程按同一时间基准调度
+    Clock::time_point anchorTime() const;
+    qint64 anchorFrame() const;
+    qint64 droppedFrames() const;
+
+signals:
+    void frameTick(qint64 frame_no);
+    void playingChanged(bool playing);
+    void rateChanged(double rate);
+    void loopRangeChanged(qint64 first, qint64 last);
+    // 时钟锚点重新设置：开始播放、seek()、速率或fps变化；循环回绕只平移锚点帧，不发出此信号
+    void anchorChanged();
+
+private:
+    void onTimeout();
+    void onFpsChanged();
+
+    void reanchor(qint64 frame_no);
+    void scheduleNextTick();
+    void scrollToFrame(qint64 frame_no);
+    qint64 frameAt(Clock::time_point time_point) const;
+    Clock::time_point timeOfFrame(qint64 frame_no) const;
+    qint64 playFirst() const;
+    qint64 playLast() const;
+
+private:
+    TimelineTransportPrivate* d_ { nullptr };
+};
+
+} // namespace tl
\ No newline at end of file
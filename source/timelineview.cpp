@@ -5,7 +5,9 @@
 #include "timelineranger.h"
 #include "timelinerangeslider.h"
 #include "timelinescene.h"
+#include "timelinetransport.h"
 #include <QMouseEvent>
+#include <QPointer>
 #include <QWheelEvent>
 
 namespace tl {
@@ -15,7 +17,10 @@ struct TimelineViewPrivate {
     TimelineAxis* axis { nullptr };
     TimelineScene* scene { nullptr };
     TimelineRanger* ranger { nullptr };
+    // 播放控制由外部持有，销毁后自动置空
+    QPointer<TimelineTransport> transport;
     QList<QMetaObject::Connection> model_connections;
+    QList<QMetaObject::Connection> transport_connections;
 };
 
 TimelineView::TimelineView(QWidget* parent)
@@ -157,6 +162,9 @@ void TimelineView::setScene(TimelineScene* scene)
     d_->model_connections.emplace_back(connect(d_->ranger->slider(), &TimelineRangeSlider::viewMinimumChanged, model, &TimelineModel::setViewFrameMinimum));
     d_->model_connections.emplace_back(connect(d_->ranger->slider(), &TimelineRangeSlider::viewMaximumChanged, model, &TimelineModel::setViewFrameMaximum));
     d_->model_connections.emplace_back(connect(d_->ranger, &TimelineRanger::fpsChanged, model, &TimelineModel::setFps));
+    // 吸附目标中的播放头跟随标尺上的播放头
+    d_->model_connections.emplace_back(connect(d_->axis, &TimelineAxis::frameChanged, model, &TimelineModel::setSnapPlayhead));
+    model->setSnapPlayhead(d_->axis->frame());
 }
 
 void TimelineView::setAxisPlayheadHeight(int height)
@@ -179,6 +187,31 @@ TimelineModel* TimelineView::model() const
     return d_->scene->model();
 }
 
+void TimelineView::setTransport(TimelineTransport* transport)
+{
+    if (transport == d_->transport) {
+        return;
+    }
+    for (auto& connection : d_->transport_connections) {
+        disconnect(connection);
+    }
+    d_->transport_connections.clear();
+    d_->transport = transport;
+    if (!transport) {
+        return;
+    }
+
+    d_->transport_connections.emplace_back(connect(transport, &TimelineTransport::frameTick, d_->axis, &TimelineAxis::movePlayhead));
+    d_->transport_connections.emplace_back(connect(d_->axis, &TimelineAxis::playheadPressed, transport, &TimelineTransport::beginScrub));
+    d_->transport_connections.emplace_back(connect(d_->axis, &TimelineAxis::playheadReleased, transport, &TimelineTransport::endScrub));
+    d_->axis->movePlayhead(transport->frame());
+}
+
+TimelineTransport* TimelineView::transport() const
+{
+    return d_->transport;
+}
+
 void TimelineView::setFormat(FrameFormat fmt)
 {
     d_->ranger->setFormat(fmt);
@@ -222,7 +255,7 @@ void TimelineView::onViewFrameMaximumChanged(qint64 value)
     }
     d_->axis->setMaximum(value);
     d_->scene->fitInAxis();
-    d_->axis->restoreValue();
+    restorePlayhead();
 }
 
 void TimelineView::onViewFrameMinimumChanged(qint64 value)
@@ -236,6 +269,16 @@ void TimelineView::onViewFrameMinimumChanged(qint64 value)
     }
     d_->axis->setMinimum(value);
     d_->scene->fitInAxis();
+    restorePlayhead();
+}
+
+void TimelineView::restorePlayhead()
+{
+    // 播放控制自动滚动时直接修改视图范围，不经过滑块，备份的帧已过期，以播放控制的当前帧为准
+    if (d_->transport) {
+        d_->axis->movePlayhead(d_->transport->frame());
+        return;
+    }
     d_->axis->restoreValue();
 }
 
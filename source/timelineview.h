@@ -8,6 +8,7 @@ namespace tl {
 class TimelineAxis;
 class TimelineScene;
 class TimelineModel;
+class TimelineTransport;
 struct TimelineViewPrivate;
 class TIMELINE_LIB_EXPORT TimelineView : public QGraphicsView {
     Q_OBJECT
@@ -24,6 +25,9 @@ public:
     TimelineAxis* axis() const;
     TimelineModel* model() const;
 
+    void setTransport(TimelineTransport* transport);
+    TimelineTransport* transport() const;
+
     void setFormat(FrameFormat fmt);
     FrameFormat format() const;
     qreal mapFromSceneX(qreal x) const;
@@ -48,6 +52,8 @@ private:
     void onFrameMaximumChanged(qint64 value);
     void onFrameMinimumChanged(qint64 value);
     void onFpsChanged(double fps);
+    // 视图范围变化后把播放头放回原来的帧
+    void restorePlayhead();
 
 private:
     TimelineViewPrivate* d_ { nullptr };
@@ -0,0 +1,94 @@
+#include "item/timelinearmitem.h"
+#include "timelinemodel.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+constexpr int kItemCount = 200'000;
+constexpr int kRowCount = 8;
+constexpr qint64 kKeyInterval = 25;
+
+double elapsedMs(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+const char* formatName(tl::FileFormat format)
+{
+    switch (format) {
+    case tl::FileFormat::Cbor:
+        return "cbor";
+    case tl::FileFormat::MessagePack:
+        return "msgpack";
+    default:
+        return "json";
+    }
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    tl::TimelineModel model;
+    model.setRowCount(kRowCount);
+    model.setFrameMaximum(kItemCount / kRowCount * kKeyInterval + kKeyInterval);
+
+    auto build_begin = std::chrono::steady_clock::now();
+    std::vector<double> angles(7);
+    for (int i = 0; i < kItemCount; ++i) {
+        int row = i % kRowCount;
+        qint64 start = (i / kRowCount) * kKeyInterval;
+        auto item_id = model.createItem(tl::TimelineArmItem::Type, row, start, 5, true);
+        for (std::size_t joint = 0; joint < angles.size(); ++joint) {
+            angles[joint] = i * 0.01 + joint;
+        }
+        model.item<tl::TimelineArmItem>(item_id)->setAngles(angles);
+    }
+    std::printf("build: %d items in %.1f ms\n", kItemCount, elapsedMs(build_begin));
+
+    for (auto format : { tl::FileFormat::Json, tl::FileFormat::Cbor, tl::FileFormat::MessagePack }) {
+        auto save_begin = std::chrono::steady_clock::now();
+        QByteArray data = model.saveToData(format);
+        double save_ms = elapsedMs(save_begin);
+
+        tl::TimelineModel loaded;
+        auto load_begin = std::chrono::steady_clock::now();
+        bool ok = loaded.loadFromData(data);
+        double load_ms = elapsedMs(load_begin);
+
+        std::printf("%-8s size %8.2f MB  save %8.1f ms  load %8.1f ms  detected %s  %s\n", formatName(format), data.size() / 1024.0 / 1024.0, save_ms, load_ms,
+            formatName(tl::TimelineModel::detectFileFormat(data)), ok ? "ok" : "FAILED");
+    }
+
+    // 列式文件：打开只建立索引，条目在访问时构造
+    QString columnar_path = QDir::temp().filePath("benchmark_project_io.tlcol");
+    auto save_begin = std::chrono::steady_clock::now();
+    bool saved = model.saveColumnar(columnar_path);
+    double save_ms = elapsedMs(save_begin);
+
+    tl::TimelineModel opened;
+    auto open_begin = std::chrono::steady_clock::now();
+    bool ok = saved && opened.openColumnar(columnar_path);
+    double open_ms = elapsedMs(open_begin);
+
+    constexpr int kWindowItems = 1000;
+    auto access_begin = std::chrono::steady_clock::now();
+    int materialized = 0;
+    for (const auto& [_, item_id] : opened.rowItemRange(0)) {
+        if (materialized == kWindowItems || !opened.item(item_id)) {
+            break;
+        }
+        ++materialized;
+    }
+    double access_ms = elapsedMs(access_begin);
+
+    std::printf("%-8s size %8.2f MB  save %8.1f ms  open %8.1f ms  access %d items %6.1f ms  %s\n", "columnar", QFileInfo(columnar_path).size() / 1024.0 / 1024.0,
+        save_ms, open_ms, materialized, access_ms, ok ? "ok" : "FAILED");
+    QFile::remove(columnar_path);
+    return 0;
+}
\ No newline at end of file
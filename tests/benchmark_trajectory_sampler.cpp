@@ -0,0 +1,53 @@
+#include "item/timelinearmitem.h"
+#include "timelinemodel.h"
+#include "timelinetrajectorysampler.h"
+#include <QCoreApplication>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+constexpr qint64 kFrameCount = 1'000'000;
+constexpr qint64 kKeyInterval = 25;
+constexpr int kJointCount = 7;
+
+double elapsedMs(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    tl::TimelineModel model;
+    model.setFrameMaximum(kFrameCount);
+    model.setRowCount(1);
+
+    // 每kKeyInterval帧一个关键帧，每隔一个关键帧停留5帧，相邻关键帧全部连接
+    auto build_begin = std::chrono::steady_clock::now();
+    std::vector<double> angles(kJointCount);
+    for (qint64 start = 0; start < kFrameCount; start += kKeyInterval) {
+        qint64 duration = (start / kKeyInterval) % 2 == 0 ? 5 : 0;
+        auto item_id = model.createItem(tl::TimelineArmItem::Type, 0, start, duration, true);
+        for (int joint = 0; joint < kJointCount; ++joint) {
+            angles[joint] = std::sin(start * 0.001 + joint) * 90.0;
+        }
+        model.item<tl::TimelineArmItem>(item_id)->setAngles(angles);
+    }
+    std::printf("build: %d items in %.1f ms\n", model.rowItemCount(0), elapsedMs(build_begin));
+
+    tl::TimelineTrajectorySampler sampler(&model);
+    for (auto interpolation : { tl::TimelineTrajectorySampler::Interpolation::Linear, tl::TimelineTrajectorySampler::Interpolation::Cubic }) {
+        sampler.setInterpolation(interpolation);
+        auto begin = std::chrono::steady_clock::now();
+        auto samples = sampler.sampleRow(0, 0, kFrameCount - 1);
+        double ms = elapsedMs(begin);
+        double samples_per_sec = static_cast<double>(samples.frame_count) * samples.channel_count / (ms / 1000.0);
+        std::printf("%s: %lld frames x %d joints in %.1f ms (%.1f M samples/s), checksum %.6f\n",
+            interpolation == tl::TimelineTrajectorySampler::Interpolation::Linear ? "linear" : "cubic",
+            samples.frame_count, samples.channel_count, ms, samples_per_sec / 1e6, samples.value(kJointCount - 1, kFrameCount / 2));
+    }
+    return 0;
+}
\ No newline at end of file
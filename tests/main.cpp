@@ -6,6 +6,7 @@
 #include "timelinemodel.h"
 #include "timelinescene.h"
 #include "timelinetransaction.h"
+#include "timelinetransport.h"
 #include "timelineview.h"
 #include <QApplication>
 #include <QClipboard>
@@ -31,6 +32,10 @@ int main(int argc, char* argv[])
     model->setRowCount(3);
     model->setFps(25.0);
 
+    tl::TimelineTransport* transport = new tl::TimelineTransport(model, &view);
+    view.setTransport(transport);
+    view.addAction("Play/Pause", QString("Space"), &view, [transport] { transport->togglePlay(); });
+
     // TODO: Only for test
     view.addAction("Add Audio", QString("Ctrl+A"), &view, [model, &view, scene] {
         qint64 start = view.axis()->frame();
@@ -78,12 +83,22 @@ int main(int argc, char* argv[])
     QObject::connect(scene, &tl::TimelineScene::requestMoveItem, &view,
         [scene](tl::ItemID item_id, qint64 frame_no) { scene->model()->modifyItemStart(item_id, frame_no); });
 
+    QObject::connect(scene, &tl::TimelineScene::requestMoveItems, &view,
+        [scene](const QList<tl::ItemID>& item_ids, qint64 delta) { scene->recordUndo(new tl::TimelineItemsMoveCommand(scene->model(), item_ids, delta)); });
+
     QObject::connect(scene, &tl::TimelineScene::requestRecordMoveCommand, &view,
         [scene](tl::ItemID item_id, qint64 frame_no) { scene->recordUndo(new tl::TimelineItemMoveCommand(scene->model(), item_id, frame_no)); });
 
     QObject::connect(scene, &tl::TimelineScene::requestItemContextMenu, &view, [model, scene, &view](tl::ItemID item_id) {
         QMenu menu(&view);
-        menu.addAction("Remove", QString("Del"), &view, [scene, model, item_id] { scene->recordUndo(new tl::TimelineItemDeleteCommand(model, item_id)); });
+        menu.addAction("Remove", QString("Del"), &view, [scene, model, item_id] {
+            auto item_ids = scene->selectedItems();
+            if (item_ids.size() > 1 && item_ids.contains(item_id)) {
+                scene->recordUndo(new tl::TimelineItemsDeleteCommand(model, item_ids));
+                return;
+            }
+            scene->recordUndo(new tl::TimelineItemDeleteCommand(model, item_id));
+        });
         menu.addAction("Copy", &view, [model, item_id] {
             auto data = model->copyItem(item_id);
             if (data.isEmpty()) {